@@ -0,0 +1,248 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file bitBlockKernel.h
+ * @brief Geometría del bloque de bits, fijada en tiempo de compilación. Por defecto 3x3; se puede
+ * compilar con otro bloque añadiendo a CFLAGS, por ejemplo, -DBITBLOCK_ROWS=4 -DBITBLOCK_COLS=4.
+ *
+ * Todo lo que depende del bloque (extracción del patrón, valor, veredictos, mapas de overflow...)
+ * se expande a partir de estas macros, de manera que cada geometría compila a código en línea
+ * recta de desplazamientos y máscaras, sin bucles sobre el tamaño del bloque.
+ *
+ * El pivot es siempre la celda (1, 1) del bloque (o la fila/columna 0 si el bloque solo tiene
+ * una), que en el 3x3 es justo el centro. Así la posición de inicio de Iñatrix es válida para
+ * cualquier bloque.
+ */
+
+#ifndef INATRIX_OVERFLOW_BITBLOCKKERNEL_H
+#define INATRIX_OVERFLOW_BITBLOCKKERNEL_H
+
+#ifndef BITBLOCK_ROWS
+#define BITBLOCK_ROWS 3
+#endif
+
+#ifndef BITBLOCK_COLS
+#define BITBLOCK_COLS 3
+#endif
+
+#define BITBLOCK_MAX_ROWS 5
+#define BITBLOCK_CELLS (BITBLOCK_ROWS * BITBLOCK_COLS)
+#define BITBLOCK_TOP (BITBLOCK_ROWS > 1 ? 1 : 0)
+#define BITBLOCK_BOTTOM (BITBLOCK_ROWS - 1 - BITBLOCK_TOP)
+#define BITBLOCK_LEFT (BITBLOCK_COLS > 1 ? 1 : 0)
+#define BITBLOCK_RIGHT (BITBLOCK_COLS - 1 - BITBLOCK_LEFT)
+#define BITBLOCK_MASK ((1 << BITBLOCK_COLS) - 1)
+#define BITBLOCK_MAX_VALUE (BITBLOCK_ROWS * BITBLOCK_MASK)
+
+/**
+ * Límites de overflow: misma proporción sobre el valor máximo del bloque que en el 3x3 original
+ * (9 y 15 sobre 21).
+ */
+#define OVERFLOW_NM ((BITBLOCK_MAX_VALUE * 3) / 7)
+#define OVERFLOW_HM ((BITBLOCK_MAX_VALUE * 5) / 7)
+
+/**
+ * Entradas de evaluación: valor del bloque en los bits bajos y veredicto de overflow de cada
+ * dificultad en los altos, ver @def BITBLOCK_OVERFLOW_FLAG.
+ */
+#define BITBLOCK_VALUE_BITS 6
+#define BITBLOCK_VALUE_MASK ((1 << BITBLOCK_VALUE_BITS) - 1)
+#define BITBLOCK_OVERFLOW_FLAG(mode) BIT(BITBLOCK_VALUE_BITS + (mode))
+
+#if (BITBLOCK_ROWS > BITBLOCK_MAX_ROWS) || (BITBLOCK_CELLS > 16) || (BITBLOCK_MAX_VALUE > BITBLOCK_VALUE_MASK)
+#error "Bloque de bits no soportado: como mucho 5 filas, 16 celdas y un valor máximo de 63."
+#endif
+
+/**
+ * Estrategia de evaluación: con patrones de hasta 10 bits (1 KB) se usa una tabla precalculada,
+ * un único acceso por bloque. Con patrones más grandes la tabla no compensa en memoria, así que
+ * el valor se obtiene sumando directamente los campos de cada fila del patrón.
+ */
+#define BITBLOCK_TABLE_MAX_BITS 10
+#define BITBLOCK_LOOKUP_TABLE (BITBLOCK_CELLS <= BITBLOCK_TABLE_MAX_BITS)
+#define BITBLOCK_PATTERNS (1 << BITBLOCK_CELLS)
+
+/**
+ * Patrón del bloque: las filas del bloque concatenadas, la superior en los bits más significativos.
+ * Cada término se descarta en tiempo de compilación si la fila no existe en el bloque.
+ */
+#define BITBLOCK_ROW_SHIFT(row) ((row) < BITBLOCK_ROWS ? BITBLOCK_COLS * (BITBLOCK_ROWS - 1 - (row)) : 0)
+#define BITBLOCK_ROW_VALUE(pattern, row) ((row) < BITBLOCK_ROWS \
+                                         ? (((pattern) >> BITBLOCK_ROW_SHIFT(row)) & BITBLOCK_MASK) : 0)
+#define BITBLOCK_VALUE(pattern) (BITBLOCK_ROW_VALUE(pattern, 0) + BITBLOCK_ROW_VALUE(pattern, 1) \
+                                + BITBLOCK_ROW_VALUE(pattern, 2) + BITBLOCK_ROW_VALUE(pattern, 3) \
+                                + BITBLOCK_ROW_VALUE(pattern, 4))
+#define BITBLOCK_RULE_ENTRY(value, nm, hm) (((value) > BITBLOCK_VALUE_MASK ? BITBLOCK_VALUE_MASK : (value)) \
+                                           | (((value) > (nm)) << BITBLOCK_VALUE_BITS) \
+                                           | (((value) > (hm)) << (BITBLOCK_VALUE_BITS + 1)))
+
+/**
+ * Formas de selección (@enum BitBlockShape): máscaras sobre el patrón del bloque con las celdas que
+ * forman parte de la forma. Las celdas que quedan fuera valen 0 al evaluar, y los límites de cada
+ * regla se calculan sobre el máximo de la propia forma (el valor de su máscara), de manera que todas
+ * las formas mantienen la proporción de @def OVERFLOW_NM y @def OVERFLOW_HM.
+ * Las celdas de cada columna de una forma han de ser contiguas (ver @fn matrix_collapseBitBlock).
+ * Se definen como constantes de enum para que cada entrada de las tablas expanda un único símbolo.
+ */
+#define BITBLOCK_COL_SHIFT(col) ((col) < BITBLOCK_COLS ? BITBLOCK_COLS - 1 - (col) : 0)
+#define BITBLOCK_CELL_BIT(row, col) (((row) < BITBLOCK_ROWS) && ((col) < BITBLOCK_COLS) \
+        ? 1 << (BITBLOCK_ROW_SHIFT(row) + BITBLOCK_COL_SHIFT(col)) : 0)
+#define BITBLOCK_ROW_BITS(row) ((row) < BITBLOCK_ROWS ? BITBLOCK_MASK << BITBLOCK_ROW_SHIFT(row) : 0)
+#define BITBLOCK_COLUMN_BITS(col) (BITBLOCK_CELL_BIT(0, col) | BITBLOCK_CELL_BIT(1, col) | BITBLOCK_CELL_BIT(2, col) \
+                                  | BITBLOCK_CELL_BIT(3, col) | BITBLOCK_CELL_BIT(4, col))
+
+enum {
+    BITBLOCK_SHAPE_MASK_SQUARE = BITBLOCK_PATTERNS - 1,
+    BITBLOCK_SHAPE_MASK_PLUS = BITBLOCK_ROW_BITS(BITBLOCK_TOP) | BITBLOCK_COLUMN_BITS(BITBLOCK_LEFT),
+    BITBLOCK_SHAPE_MASK_L = BITBLOCK_COLUMN_BITS(BITBLOCK_LEFT)
+                            | ((BITBLOCK_MASK >> BITBLOCK_LEFT) << BITBLOCK_ROW_SHIFT(BITBLOCK_ROWS - 1)),
+    BITBLOCK_SHAPE_MASK_LINE = BITBLOCK_ROW_BITS(BITBLOCK_TOP),
+    BITBLOCK_SHAPE_MASK_SMALL_SQUARE = BITBLOCK_CELL_BIT(BITBLOCK_TOP, BITBLOCK_LEFT)
+                                       | BITBLOCK_CELL_BIT(BITBLOCK_TOP, BITBLOCK_LEFT + 1)
+                                       | BITBLOCK_CELL_BIT(BITBLOCK_TOP + 1, BITBLOCK_LEFT)
+                                       | BITBLOCK_CELL_BIT(BITBLOCK_TOP + 1, BITBLOCK_LEFT + 1)
+};
+
+/**
+ * @enum BitBlockShape
+ * @brief Forma de la selección alrededor del pivot, dentro del bloque. Máscara de
+ * cada una en @def BITBLOCK_SHAPE_MASK_SQUARE y siguientes.
+ * BITBLOCK_SHAPE_SQUARE: el bloque entero (la selección original).
+ * BITBLOCK_SHAPE_PLUS: la fila y la columna del pivot.
+ * BITBLOCK_SHAPE_L: la columna del pivot y, en la fila inferior, lo que queda a su derecha.
+ * BITBLOCK_SHAPE_LINE: la fila del pivot.
+ * BITBLOCK_SHAPE_SMALL_SQUARE: 2x2 con el pivot en la esquina superior izquierda.
+ */
+typedef enum {
+    BITBLOCK_SHAPE_SQUARE = 0,
+    BITBLOCK_SHAPE_PLUS = 1,
+    BITBLOCK_SHAPE_L = 2,
+    BITBLOCK_SHAPE_LINE = 3,
+    BITBLOCK_SHAPE_SMALL_SQUARE = 4,
+    BITBLOCK_SHAPES
+} BitBlockShape;
+
+#define BITBLOCK_SHAPE_ENTRY(value, max) BITBLOCK_RULE_ENTRY(value, ((max) * 3) / 7, ((max) * 5) / 7)
+#define BITBLOCK_ENTRY(pattern, mask) BITBLOCK_SHAPE_ENTRY(BITBLOCK_VALUE((pattern) & (mask)), BITBLOCK_VALUE(mask))
+
+/**
+ * Reglas de overflow alternativas (@enum OverflowRule). Cada una define la entrada de evaluación
+ * de un patrón con una forma, de manera que también se tabulan en tiempo de compilación.
+ *
+ * Columnas: cada columna leída en binario de arriba abajo. La suma de las columnas es la de los
+ * bits a 1 de cada fila, con el peso de la fila.
+ */
+#define BITBLOCK_ROW_WEIGHT(row) ((row) < BITBLOCK_ROWS ? BITBLOCK_ROWS - 1 - (row) : 0)
+#define BITBLOCK_COLUMNS_ROW(pattern, row) (__builtin_popcount(BITBLOCK_ROW_VALUE(pattern, row)) \
+                                           << BITBLOCK_ROW_WEIGHT(row))
+#define BITBLOCK_COLUMNS_VALUE(pattern) (BITBLOCK_COLUMNS_ROW(pattern, 0) + BITBLOCK_COLUMNS_ROW(pattern, 1) \
+                                        + BITBLOCK_COLUMNS_ROW(pattern, 2) + BITBLOCK_COLUMNS_ROW(pattern, 3) \
+                                        + BITBLOCK_COLUMNS_ROW(pattern, 4))
+#define BITBLOCK_COLUMNS_ENTRY(pattern, mask) BITBLOCK_SHAPE_ENTRY(BITBLOCK_COLUMNS_VALUE((pattern) & (mask)), \
+                                                                  BITBLOCK_COLUMNS_VALUE(mask))
+
+/**
+ * Diagonales: la principal y la secundaria (de la esquina superior derecha hacia abajo) leídas en
+ * binario de arriba abajo. En bloques no cuadrados, las del cuadrado superior.
+ */
+#define BITBLOCK_DIAGONAL (BITBLOCK_ROWS < BITBLOCK_COLS ? BITBLOCK_ROWS : BITBLOCK_COLS)
+#define BITBLOCK_DIAGONAL_WEIGHT(row) ((row) < BITBLOCK_DIAGONAL ? BITBLOCK_DIAGONAL - 1 - (row) : 0)
+#define BITBLOCK_CELL(pattern, row, col) ((row) < BITBLOCK_DIAGONAL \
+        ? ((pattern) >> (BITBLOCK_ROW_SHIFT(row) + BITBLOCK_COLS - 1 - (col))) & 1 : 0)
+#define BITBLOCK_DIAGONALS_ROW(pattern, row) ((BITBLOCK_CELL(pattern, row, row) \
+        + BITBLOCK_CELL(pattern, row, BITBLOCK_COLS - 1 - (row))) << BITBLOCK_DIAGONAL_WEIGHT(row))
+#define BITBLOCK_DIAGONALS_VALUE(pattern) (BITBLOCK_DIAGONALS_ROW(pattern, 0) + BITBLOCK_DIAGONALS_ROW(pattern, 1) \
+                                          + BITBLOCK_DIAGONALS_ROW(pattern, 2) + BITBLOCK_DIAGONALS_ROW(pattern, 3) \
+                                          + BITBLOCK_DIAGONALS_ROW(pattern, 4))
+#define BITBLOCK_DIAGONALS_ENTRY(pattern, mask) BITBLOCK_SHAPE_ENTRY(BITBLOCK_DIAGONALS_VALUE((pattern) & (mask)), \
+                                                                    BITBLOCK_DIAGONALS_VALUE(mask))
+
+/**
+ * Filas con signo: cada fila en complemento a 2. Para que el valor de la entrada no sea negativo
+ * se guarda desplazado en @def BITBLOCK_SIGN_BIAS; desplazar una fila es invertir su bit de signo.
+ * El máximo de una forma es el de sus filas con todos los bits a 1 salvo el de signo.
+ */
+#define BITBLOCK_SIGN_BIT (1 << (BITBLOCK_COLS - 1))
+#define BITBLOCK_SIGN_BIAS (BITBLOCK_ROWS * BITBLOCK_SIGN_BIT)
+#define BITBLOCK_SIGNED_ROW(pattern, row) ((row) < BITBLOCK_ROWS \
+                                          ? BITBLOCK_ROW_VALUE(pattern, row) ^ BITBLOCK_SIGN_BIT : 0)
+#define BITBLOCK_SIGNED_VALUE(pattern) (BITBLOCK_SIGNED_ROW(pattern, 0) + BITBLOCK_SIGNED_ROW(pattern, 1) \
+                                       + BITBLOCK_SIGNED_ROW(pattern, 2) + BITBLOCK_SIGNED_ROW(pattern, 3) \
+                                       + BITBLOCK_SIGNED_ROW(pattern, 4))
+#define BITBLOCK_SIGN_BITS BITBLOCK_COLUMN_BITS(0)
+#define BITBLOCK_SIGNED_MAX_OF(mask) (BITBLOCK_VALUE(mask) - __builtin_popcount((mask) & BITBLOCK_SIGN_BITS) \
+                                     * BITBLOCK_SIGN_BIT)
+#define BITBLOCK_SIGNED_ENTRY(pattern, mask) BITBLOCK_RULE_ENTRY(BITBLOCK_SIGNED_VALUE((pattern) & (mask)), \
+        BITBLOCK_SIGN_BIAS + (BITBLOCK_SIGNED_MAX_OF(mask) * 3) / 7, \
+        BITBLOCK_SIGN_BIAS + (BITBLOCK_SIGNED_MAX_OF(mask) * 5) / 7)
+
+/**
+ * Por filas: hay overflow si alguna fila, por sí sola, supera el límite (proporcional al máximo de
+ * esa fila dentro de la forma). El valor de la entrada sigue siendo la suma de las filas.
+ */
+#define BITBLOCK_ROW_OVER(pattern, mask, row, num) (BITBLOCK_ROW_VALUE((pattern) & (mask), row) \
+                                                   > (BITBLOCK_ROW_VALUE(mask, row) * (num)) / 7)
+#define BITBLOCK_ANY_ROW_OVER(pattern, mask, num) (BITBLOCK_ROW_OVER(pattern, mask, 0, num) \
+                                                  | BITBLOCK_ROW_OVER(pattern, mask, 1, num) \
+                                                  | BITBLOCK_ROW_OVER(pattern, mask, 2, num) \
+                                                  | BITBLOCK_ROW_OVER(pattern, mask, 3, num) \
+                                                  | BITBLOCK_ROW_OVER(pattern, mask, 4, num))
+#define BITBLOCK_ANY_ROW_ENTRY(pattern, mask) (BITBLOCK_VALUE((pattern) & (mask)) \
+        | (BITBLOCK_ANY_ROW_OVER(pattern, mask, 3) << BITBLOCK_VALUE_BITS) \
+        | (BITBLOCK_ANY_ROW_OVER(pattern, mask, 5) << (BITBLOCK_VALUE_BITS + 1)))
+
+#define BITBLOCK_PATTERN_ROW(rows, i, shift, row) ((row) < BITBLOCK_ROWS \
+        ? (((rows)[(i) - BITBLOCK_TOP + (row)] >> (shift)) & BITBLOCK_MASK) << BITBLOCK_ROW_SHIFT(row) : 0)
+#define BITBLOCK_PATTERN(rows, i, shift) (BITBLOCK_PATTERN_ROW(rows, i, shift, 0) \
+                                         | BITBLOCK_PATTERN_ROW(rows, i, shift, 1) \
+                                         | BITBLOCK_PATTERN_ROW(rows, i, shift, 2) \
+                                         | BITBLOCK_PATTERN_ROW(rows, i, shift, 3) \
+                                         | BITBLOCK_PATTERN_ROW(rows, i, shift, 4))
+
+/**
+ * Mismo patrón, pero montado a partir de las ventanas ya extraídas de cada fila (ver la caché
+ * @var rowWindows de matrix.c): una lectura y un desplazamiento por fila.
+ */
+#define BITBLOCK_WINDOWS_ROW(windows, i, j, row) ((row) < BITBLOCK_ROWS \
+        ? (windows)[(i) - BITBLOCK_TOP + (row)][j] << BITBLOCK_ROW_SHIFT(row) : 0)
+#define BITBLOCK_WINDOWS_PATTERN(windows, i, j) (BITBLOCK_WINDOWS_ROW(windows, i, j, 0) \
+                                                | BITBLOCK_WINDOWS_ROW(windows, i, j, 1) \
+                                                | BITBLOCK_WINDOWS_ROW(windows, i, j, 2) \
+                                                | BITBLOCK_WINDOWS_ROW(windows, i, j, 3) \
+                                                | BITBLOCK_WINDOWS_ROW(windows, i, j, 4))
+
+/**
+ * Desplazamiento que deja en los bits bajos de una fila de tamaño size las columnas del bloque
+ * cuyo pivot está en la columna j.
+ */
+#define BITBLOCK_SHIFT(size, j) ((size) - 1 - ((j) + BITBLOCK_RIGHT))
+
+/**
+ * Rango de pivots válidos de una matriz de tamaño size (el bloque ha de caber entero).
+ */
+#define MATRIX_FIRST_PIVOT_I BITBLOCK_TOP
+#define MATRIX_FIRST_PIVOT_J BITBLOCK_LEFT
+#define MATRIX_LAST_PIVOT_I(size) ((size) - 1 - BITBLOCK_BOTTOM)
+#define MATRIX_LAST_PIVOT_J(size) ((size) - 1 - BITBLOCK_RIGHT)
+#define MATRIX_PIVOTS_I(size) ((size) - BITBLOCK_ROWS + 1)
+#define MATRIX_PIVOTS_J(size) ((size) - BITBLOCK_COLS + 1)
+
+#endif //INATRIX_OVERFLOW_BITBLOCKKERNEL_H
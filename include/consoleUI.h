@@ -29,15 +29,16 @@ extern void consoleUI_showMenu();
 extern void consoleUI_showIntro1();
 extern void consoleUI_showIntro2();
 extern void consoleUI_showUI();
+extern void consoleUI_showHint();
 extern void consoleUI_showOverflow();
 extern void consoleUI_showRegeneratingMatrix();
 extern void consoleUI_showFail();
 extern void consoleUI_showGameOver();
 extern void consoleUI_showStats();
 extern void consoleUI_showPauseUI();
-extern void consoleUI_showSurrender();
+extern void consoleUI_showSurrenderUI();
 extern void consoleUI_showControls();
-extern void consoleUI_showGamePlay();
+extern void consoleUI_showGameplay();
 extern void consoleUI_showLore();
 extern void consoleUI_showLore2();
 
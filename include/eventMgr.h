@@ -26,25 +26,66 @@
 #define EVENTMGR_H
 
 #include "defines.h"
+#include "timer.h"
 
-#define MAX_EVENTS 20
+/**
+ * Eventos pendientes que caben en el pool. La capacidad se fija al compilar y no crece: con el pool
+ * lleno, @fn eventMgr_ScheduleEvent no programa el evento (devuelve EVENT_HANDLE_NONE y lo cuenta en
+ * @var eventPoolStats). Los 128 por defecto sobran para el juego; un modo con guión con miles de
+ * eventos pendientes HA de compilarse con un pool mayor, p.ej. -DEVENT_POOL_SIZE=16384 en CFLAGS
+ * (12 bytes por evento en la NDS). Como mucho 65535: el índice del hueco va en 16 bits de
+ * @typedef EventHandle.
+ * Un evento cancelado con @fn eventMgr_CancelEvent sigue ocupando su hueco hasta que vence su plazo
+ * (sólo se marca): cancelar un evento lejano no hace sitio en el pool hasta entonces. Para vaciarlo
+ * al momento, @fn eventMgr_cancelAllEvents.
+ */
+#ifndef EVENT_POOL_SIZE
+#define EVENT_POOL_SIZE 128
+#endif
+
+#if EVENT_POOL_SIZE > 0xFFFF
+#error "EVENT_POOL_SIZE no puede pasar de 65535."
+#endif
+
+/**
+ * Rueda de tiempo jerárquica (ver eventMgr.c): @def EVENT_WHEEL_LEVELS niveles de
+ * @def EVENT_WHEEL_SLOTS huecos; cada hueco del nivel l abarca EVENT_WHEEL_SPAN(l) ticks del timer
+ * (el horizonte, 2^18 ticks, son 512 segundos).
+ */
+#define EVENT_WHEEL_BITS 6
+#define EVENT_WHEEL_SLOTS (1 << EVENT_WHEEL_BITS)
+#define EVENT_WHEEL_MASK (EVENT_WHEEL_SLOTS - 1)
+#define EVENT_WHEEL_LEVELS 3
+#define EVENT_WHEEL_SPAN(level) (1 << (EVENT_WHEEL_BITS * (level)))
+#define EVENT_WHEEL_HORIZON EVENT_WHEEL_SPAN(EVENT_WHEEL_LEVELS)
+
+/**
+ * Los plazos de los eventos se cuentan en ticks del timer (@def TIMER0_FREQ por segundo, ~2 ms cada
+ * uno). EVENT_SECONDS y EVENT_MS pasan a ticks, el segundo redondeando al tick más cercano.
+ */
+#define EVENT_SECONDS(s) ((s) * TIMER0_FREQ)
+#define EVENT_MS(ms) (((ms) * TIMER0_FREQ + 500) / 1000)
 
 /**
  * @enum TimeMarks
- * @brief Marcas de tiempo para programar eventos.
+ * @brief Marcas de tiempo para programar eventos, en ticks.
  */
 enum TimeMarks {
     NO_WAIT      = 0,
-    IN_1_SECONDS = 1,
-    IN_2_SECONDS = 2,
-    IN_3_SECONDS = 3,
-    IN_4_SECONDS = 4,
-    IN_5_SECONDS = 5,
-    IN_6_SECONDS = 6,
-    IN_7_SECONDS = 7,
-    IN_8_SECONDS = 8,
-    IN_10_SECONDS = 10,
-    IN_20_SECONDS = 20,
+    IN_100_MS    = EVENT_MS(100),
+    IN_250_MS    = EVENT_MS(250),
+    IN_500_MS    = EVENT_MS(500),
+    IN_750_MS    = EVENT_MS(750),
+    IN_1_SECONDS = EVENT_SECONDS(1),
+    IN_2_SECONDS = EVENT_SECONDS(2),
+    IN_3_SECONDS = EVENT_SECONDS(3),
+    IN_4_SECONDS = EVENT_SECONDS(4),
+    IN_5_SECONDS = EVENT_SECONDS(5),
+    IN_6_SECONDS = EVENT_SECONDS(6),
+    IN_7_SECONDS = EVENT_SECONDS(7),
+    IN_8_SECONDS = EVENT_SECONDS(8),
+    IN_10_SECONDS = EVENT_SECONDS(10),
+    IN_20_SECONDS = EVENT_SECONDS(20),
 };
 
 /**
@@ -94,6 +135,7 @@ typedef enum {
     EVENT_GAME_UI_SHOW_OVERFLOW,
     EVENT_GAME_UI_SHOW_FAIL,
     EVENT_GAME_DESTROY_MATRIX_CHECK,
+    EVENT_GAME_TOGGLE_HINT,
     /**
      * GAME OVER
      */
@@ -107,29 +149,99 @@ typedef enum {
     EVENT_SHOW_GAMEPLAY,
     EVENT_SHOW_LORE,
     EVENT_SHOW_LORE_2,
-    EVENT_CLEAR_CONSOLE
+    EVENT_CLEAR_CONSOLE,
+    EVENTS_SIZE
 } Events;
 
+/**
+ * Función que se ejecuta cuando vence un evento; se registra una por evento con
+ * @fn eventMgr_RegisterHandler.
+ */
+typedef void (*EventHandler)();
+
+/**
+ * @struct EventHandlerStats
+ * @brief Contadores de cada función de evento, para ver cuánto cuesta el guión en la rutina de
+ * atención del timer.
+ * @var calls: veces que se ha ejecutado.
+ * @var cycles: ciclos de bus acumulados (ver @fn timer_ReadCycleCounter).
+ * @var maxCycles: la ejecución más cara.
+ */
+typedef struct {
+    uint32 calls;
+    uint32 cycles;
+    uint32 maxCycles;
+} EventHandlerStats;
+
+/**
+ * Identificador estable de un evento programado (lo devuelve @fn eventMgr_ScheduleEvent): índice
+ * de su hueco del pool más uno en los 16 bits bajos y generación del hueco en los altos. Un
+ * identificador de un evento ya ejecutado o cancelado no vale para el que reutilice el hueco.
+ */
+typedef uint32 EventHandle;
+#define EVENT_HANDLE_NONE 0
+
 /**
  * @struct Event
  * @brief Almacena información sobre el propio evento.
  * @var id: ID única del evento en "cola"
- * @var execTime: Indica cuándo el evento ha de ejecutarse.
+ * @var cancelled: El evento se ha cancelado; se devuelve al pool sin ejecutarse cuando venza.
+ * @var gen: Generación del hueco del pool, cambia cada vez que se devuelve (ver @typedef EventHandle).
+ * @var execTime: Indica cuándo el evento ha de ejecutarse, en ticks (@var totalTicks del timer).
+ * @var next: Siguiente evento de la cola en la que esté: la de huecos libres del pool (ver
+ * @fn eventMgr_AcquireEvent), un hueco de la rueda o la de eventos vencidos.
  */
-typedef struct {
+typedef struct Event {
     uint8 id;
+    bool cancelled;
+    uint16 gen;
     int execTime;
-    uint8 pos;
+    struct Event* next;
 } Event;
 
-extern Event* eventList[MAX_EVENTS];
-extern int numEvents;
+/**
+ * @struct EventQueue
+ * @brief Cola FIFO intrusiva de eventos, encadenados por @var next.
+ * @var head: primer evento (NULL si está vacía).
+ * @var tail: último evento.
+ */
+typedef struct {
+    Event* head;
+    Event* tail;
+} EventQueue;
+
+/**
+ * @struct EventPoolStats
+ * @brief Contadores del pool de eventos, para dimensionar @def EVENT_POOL_SIZE.
+ * @var inUse: huecos ocupados ahora mismo.
+ * @var peak: máximo de @var inUse observado.
+ * @var acquired: eventos servidos desde el pool.
+ * @var failed: peticiones que han encontrado el pool lleno (el evento no se ha programado).
+ */
+typedef struct {
+    uint16 inUse;
+    uint16 peak;
+    uint32 acquired;
+    uint32 failed;
+} EventPoolStats;
+
+extern EventQueue eventReady;
+extern EventPoolStats eventPoolStats;
+extern EventHandler eventHandlers[EVENTS_SIZE];
+extern EventHandlerStats eventHandlerStats[EVENTS_SIZE];
 
 extern void eventMgr_InitEventSystem();
+extern void eventMgr_RegisterHandler(uint8 eventId, EventHandler handler);
+extern Event* eventMgr_AcquireEvent();
+extern void eventMgr_ReleaseEvent(Event* event);
+extern void eventMgr_QueuePush(EventQueue* queue, Event* event);
+extern void eventMgr_WheelInsert(Event* event);
+extern void eventMgr_AdvanceWheel(int now);
+extern void eventMgr_CascadeWheel(uint8 level, uint8 slot);
+extern void eventMgr_ReleaseQueue(EventQueue* queue);
 extern void eventMgr_UpdateScheduledEvents();
-extern void eventMgr_AddEvent(Event *event);
-extern void eventMgr_ScheduleEvent(uint8 eventId, int time);
-extern void eventMgr_DeleteEvent(Event* event);
+extern EventHandle eventMgr_ScheduleEvent(uint8 eventId, int time);
+extern bool eventMgr_CancelEvent(EventHandle handle);
 extern void eventMgr_UpdatePhases();
 extern void eventMgr_UpdateAnimations();
 extern void eventMgr_cancelAllEvents();
@@ -29,6 +29,7 @@
 #define TIMER_REGEN_NM 25
 
 #include <stdbool.h>
+#include "bitBlockKernel.h"
 
 void game_Loop();
 void game_Update();
@@ -62,8 +63,10 @@ typedef enum {
     /* MENU */
     /* GAME */
     PHASE_BITBLOCK_FALLING,
+    PHASE_BITBLOCK_COLLAPSING,
     PHASE_DESTROYING_MATRIX,
     PHASE_REGENERATING_MATRIX,
+    PHASE_REVEALING_MATRIX,
     PHASE_MOVE_INATRIX_X,
     PHASE_MOVE_INATRIX_Y,
     PHASE_SHOW_STATS,
@@ -84,24 +87,73 @@ typedef enum {
     DIFFICULTY_HARD_MODE = 1
 } Difficulty;
 
+/**
+ * @enum Collapse
+ * @brief Qué ocurre con el hueco que deja el bloque de bits destruido.
+ * COLLAPSE_SWAP: el bloque de reemplazo aparece en el mismo sitio.
+ * COLLAPSE_GRAVITY: las celdas de encima caen a rellenar el hueco y el bloque de reemplazo aparece arriba.
+ */
+typedef enum {
+    COLLAPSE_SWAP = 0,
+    COLLAPSE_GRAVITY = 1
+} Collapse;
+
+#ifndef GAME_DEFAULT_COLLAPSE
+#define GAME_DEFAULT_COLLAPSE COLLAPSE_SWAP
+#endif
+
+/**
+ * @enum OverflowRule
+ * @brief Cómo se lee el bloque de bits para decidir si hay overflow (ver bitBlockKernel.h).
+ * OVERFLOW_RULE_ROWS: suma de las filas leídas en binario (la regla original).
+ * OVERFLOW_RULE_COLUMNS: suma de las columnas leídas en binario de arriba abajo.
+ * OVERFLOW_RULE_DIAGONALS: suma de las dos diagonales leídas en binario de arriba abajo.
+ * OVERFLOW_RULE_SIGNED_ROWS: suma de las filas leídas en complemento a 2.
+ * OVERFLOW_RULE_ANY_ROW: alguna fila, por sí sola, supera el límite.
+ */
+typedef enum {
+    OVERFLOW_RULE_ROWS = 0,
+    OVERFLOW_RULE_COLUMNS = 1,
+    OVERFLOW_RULE_DIAGONALS = 2,
+    OVERFLOW_RULE_SIGNED_ROWS = 3,
+    OVERFLOW_RULE_ANY_ROW = 4,
+    OVERFLOW_RULES
+} OverflowRule;
+
+#ifndef GAME_DEFAULT_RULE
+#define GAME_DEFAULT_RULE OVERFLOW_RULE_ROWS
+#endif
+
+#ifndef GAME_DEFAULT_SHAPE
+#define GAME_DEFAULT_SHAPE BITBLOCK_SHAPE_SQUARE
+#endif
+
 /**
  * @struct GameData
  * @brief Información general del juego.
  * @var state: estado actual del juego.
  * @var phase: phase del estado.
  * @var mode: difficultad @enum Difficulty.
+ * @var collapse: modo de regeneración del bloque de bits, @enum Collapse.
+ * @var rule: regla de overflow, @enum OverflowRule.
+ * @var shape: forma de la selección, @enum BitBlockShape.
  * @var destroyMatrixActive: indica si el sistema encargado de la gestión de
  * la destrucción/regeneración de la matriz está actualmente activo.
  * @var destroyMatrixTime: Indica el tiempo que falta para la siguiente destrucción de la matriz.
  * @var matrixRegens: Número de regeneraciones total.
+ * @var hint: Indica si el UI muestra la pista del overflow más cercano (tecla R).
 */
 typedef struct {
     int state;
     int phase;
     Difficulty mode;
+    Collapse collapse;
+    OverflowRule rule;
+    BitBlockShape shape;
     bool destroyMatrixActive;
     int destroyMatrixTime;
     int matrixRegens;
+    bool hint;
 } GameData;
 
 /**
@@ -128,6 +180,10 @@ extern bool game_manageScore(bool overflow);
 extern void game_initData();
 extern void game_launch();
 extern void game_setDifficulty(Difficulty difficulty);
+extern void game_setBitBlockEvaluation(OverflowRule rule, BitBlockShape shape);
+extern void game_setOverflowRule(OverflowRule rule);
+extern void game_setBitBlockShape(BitBlockShape shape);
+extern void game_resetMatrixPool();
 extern void game_setDestroyMatrix(bool active);
 extern void game_enableDestroyMatrix();
 extern void game_increaseMatrixRegens();
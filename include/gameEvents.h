@@ -0,0 +1,80 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file gameEvents.h
+ */
+
+#ifndef INATRIX_OVERFLOW_GAMEEVENTS_H
+#define INATRIX_OVERFLOW_GAMEEVENTS_H
+
+extern void gameEvents_registerHandlers();
+
+/**
+ * MAIN MENU
+ */
+extern void gameEvents_mainMenuStart();
+extern void gameEvents_mainMenuHideUI();
+extern void gameEvents_mainMenuShowUI();
+extern void gameEvents_showControls();
+extern void gameEvents_showGameplay();
+extern void gameEvents_showLore();
+extern void gameEvents_showLore2();
+
+/**
+ * INTRO
+ */
+extern void gameEvents_introPreStart();
+extern void gameEvents_introStart();
+extern void gameEvents_introText1();
+extern void gameEvents_introText2();
+extern void gameEvents_introRabbit2();
+extern void gameEvents_introText3();
+extern void gameEvents_introText4();
+extern void gameEvents_introShowCapsules();
+extern void gameEvents_introCapsuleSelected();
+extern void gameEvents_introFinish1();
+extern void gameEvents_introFinish2();
+extern void gameEvents_introSetBgMain();
+extern void gameEvents_introSetBg2();
+extern void gameEvents_introSetBg3();
+
+/**
+ * GAME
+ */
+extern void gameEvents_gameStart();
+extern void gameEvents_gameStartDestMatrix();
+extern void gameEvents_gameDestroyMatrixCheck();
+extern void gameEvents_gameDropBitBlock();
+extern void gameEvents_gameRegenerateBitBlock();
+extern void gameEvents_gameHideMatrix();
+extern void gameEvents_gameRegenerateMatrix();
+extern void gameEvents_gameDestroyMatrix();
+extern void gameEvents_gameInatrixMoveX();
+extern void gameEvents_gameInatrixMoveY();
+extern void gameEvents_gameEvaluateBitBlock();
+extern void gameEvents_gameUIShowBase();
+extern void gameEvents_gameToggleHint();
+extern void gameEvents_clearConsole();
+extern void gameEvents_showStats();
+extern void gameEvents_listenInput();
+extern void gameEvents_gamePause();
+
+#endif //INATRIX_OVERFLOW_GAMEEVENTS_H
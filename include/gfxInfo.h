@@ -30,8 +30,8 @@
 #include "defines.h"
 #include "matrix.h"
 
-#define GFX_NUMBER 5
-#define GFX_SIZE GFX_NUMBER + (MATRIX_SIZE * MATRIX_SIZE) + (BITBLOCK_SIZE * BITBLOCK_SIZE)
+#define GFX_NUMBER 7
+#define GFX_SIZE GFX_NUMBER + (MATRIX_VIEW_SIZE * MATRIX_VIEW_SIZE) + BITBLOCK_CELLS
 #define BITMAP_SIZE 7
 
 extern GfxData* gfxList[GFX_SIZE];
@@ -40,8 +40,8 @@ extern uint8 gfxGUID;
 
 extern void gfxInfo_setGfx(GfxID gfxId, SpriteSize size);
 extern void gfxInfo_init();
-extern void gfxInfo_initMatrix(Binary *base, uint8 size);
-extern void gfxInfo_allocateMatrixElement(GfxID gfxId);
-extern void gfxInfo_linkToMatrix(uint8 size, uint8 i, uint8 j, Binary digit);
+extern void gfxInfo_initMatrix(uint8* view, uint8 rows, uint8 cols);
+extern uint8 gfxInfo_allocateMatrixElement();
+extern GfxData* gfxInfo_getDigitGfx(Binary bit);
 extern void gfxInfo_freeMemory();
 #endif //INATRIX_OVERFLOW_GFX_BITMAPS_H
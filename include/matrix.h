@@ -28,19 +28,64 @@
 #include <stdbool.h>
 
 #include "defines.h"
+#include "rng.h"
+#include "bitBlockKernel.h"
 
-#define MATRIX_SIZE 10
+/**
+ * El tamaño de la matriz se elige al comienzo de la sesión (@fn matrix_initSystem), entre
+ * @def MATRIX_MIN_SIZE y @def MATRIX_MAX_SIZE. En pantalla solo se muestra una ventana
+ * (viewport) de @def MATRIX_VIEW_SIZE x @def MATRIX_VIEW_SIZE celdas, que se desplaza siguiendo al pivot;
+ * así el número de sprites no depende del tamaño de la matriz.
+ */
+#define MATRIX_BASE_SIZE 10
+#define MATRIX_DEFAULT_SIZE 10
+#define MATRIX_VIEW_SIZE 10
+#define MATRIX_MIN_SIZE MATRIX_VIEW_SIZE
+#define MATRIX_MAX_SIZE 32
+#define MATRIX_MAX_CELLS (MATRIX_MAX_SIZE * MATRIX_MAX_SIZE)
+#define VIEW_MASK_ALL ((1 << MATRIX_VIEW_SIZE) - 1)
 #define MATRIX_FIRST 0
 #define MATRIX_X_POS 50
 #define MATRIX_Y_POS 5
 #define MATRIX_X_PADDING 16
 #define MATRIX_Y_PADDING 15
+#define COLLAPSE_FALL(rows) ((rows) * MATRIX_Y_PADDING) // Píxeles que cae una columna al colapsar rows celdas.
+#define COLLAPSE_STEP 3 // Píxeles por frame.
+#define MATRIX_REVEAL_WINDOW_ROWS 4 // Filas de la matriz cuyas ventanas se refrescan por frame al regenerarla.
 
-#define MATRIX_BLOCK 9
-#define BITBLOCK_SIZE 3
+#define BITBLOCK_BASE_SIZE 3
 
-#define OVERFLOW_NM 9
-#define OVERFLOW_HM 15
+/**
+ * Bitboards: cada fila se empaqueta en una palabra, con la columna 0 en el bit más
+ * significativo. De ésta manera, leer una fila (o un trozo) es directamente leer su valor binario.
+ */
+#define BITBOARD_SHIFT(size, j) ((size) - 1 - (j))
+#define BITBOARD_GET(row, size, j) (((row) >> BITBOARD_SHIFT(size, j)) & 1)
+/**
+ * Fila de la celda n de un bitboard (índice 1D) sin dividir, que en la ARM946E-S (sin divisor)
+ * es una llamada a la biblioteca: (n * ceil(2^20 / width)) >> 20 es exactamente n / width para
+ * n < @def MATRIX_MAX_CELLS y width <= @def MATRIX_MAX_SIZE.
+ */
+#define BITBOARD_RECIPROCAL_SHIFT 20
+#define BITBOARD_RECIPROCAL(width) (((1 << BITBOARD_RECIPROCAL_SHIFT) + (width) - 1) / (width))
+#define BITBOARD_ROW_OF(n, reciprocal) (((uint32) (n) * (reciprocal)) >> BITBOARD_RECIPROCAL_SHIFT)
+#define BITBOARD_SET(row, size, j, bit) ((row) = ((row) & ~(((BitboardRow) 1) << BITBOARD_SHIFT(size, j))) \
+                                                | (((BitboardRow) (bit)) << BITBOARD_SHIFT(size, j)))
+
+/**
+ * Mapa de overflows: una máscara por fila de pivots, con un bit por columna de pivot (ver el rango
+ * de pivots en bitBlockKernel.h). Para calcularlo se empaquetan los valores de las ventanas de
+ * @def BITBLOCK_COLS bits de una fila en carriles (lanes) de 8 bits de una palabra de 64, uno por
+ * columna de pivot (SWAR), de 8 en 8 columnas.
+ */
+#define OVERFLOW_ROW_BIT(j) (((OverflowRow) 1) << ((j) - MATRIX_FIRST_PIVOT_J))
+#define SWAR_LANES 8
+#define SWAR_LANE_BITS 8
+#define SWAR_LANES_LOW 0x0101010101010101ULL
+#define SWAR_LANES_HIGH 0x8080808080808080ULL
+#define SWAR_LANES_GATHER 0x0102040810204080ULL
+#define OVERFLOW_MAPS 2
+#define HINT_NONE 0xFF // Coste devuelto cuando no hay ningún pivot con overflow.
 
 /**
  * @typedef Binary
@@ -60,45 +105,125 @@ typedef struct{
 } MatrixPivot;
 
 /**
- * @struct MatrixElement
- * @brief La/el matriz/bitblock están compuestos por punteros a este tipo de struct.
- * @var sprite: dirección de memoria del struct @struct Sprite.
- * @var bit: valor del digito binario, del tipo @typedef Binary.
+ * @struct MatrixViewport
+ * @brief Celda de la matriz que se muestra en la esquina superior izquierda de la pantalla.
+ * @var i: fila
+ * @var j: columna
+ */
+typedef struct{
+    uint8 i;
+    uint8 j;
+} MatrixViewport;
+
+/**
+ * @typedef ViewMask
+ * @brief Fila de celdas del viewport, un bit por columna de pantalla (bit j = columna j).
+ */
+typedef uint16 ViewMask;
+
+/**
+ * @typedef BitboardRow
+ * @brief Fila empaquetada de la matriz/bitblock, un bit por columna (hasta @def MATRIX_MAX_SIZE).
+ */
+typedef uint32 BitboardRow;
+
+/**
+ * @typedef OverflowRow
+ * @brief Máscara con los pivots de una fila que generan overflow, ver @def OVERFLOW_ROW_BIT.
+ */
+typedef uint32 OverflowRow;
+
+/**
+ * @struct OverflowMap
+ * @brief Mapa de overflow de toda la matriz, indexado por la fila del pivot.
+ * @var rows: máscara de cada fila de pivots (las filas sin pivots quedan a 0).
  */
 typedef struct{
-    Sprite* sprite;
-    Binary bit;
-} MatrixElement;
+    OverflowRow rows[MATRIX_MAX_SIZE];
+} OverflowMap;
 
 void matrix_hideMatrix(bool hide);
 void matrix_hideBitBlockBuffer(bool hide);
 
-extern void matrix_initSystem();
+extern void matrix_initSystem(uint8 size);
 extern void matrix_displayMatrix(bool display);
 extern void matrix_displayBitBlockBuffer(bool display);
 extern bool matrix_destroyMatrixEffect();
 extern void matrix_updatePivot(uint8 i, uint8 j);
 extern bool matrix_dropBitBlockEffect();
-extern bool matrix_bitConjuctionEffect();
+extern bool matrix_revealMatrixEffect();
 extern void matrix_bitShakeEffect(int8 state);
 extern void matrix_bitResetPosEffect();
 extern void matrix_regenerateBitBlock();
+extern void matrix_collapseBitBlock();
+extern bool matrix_collapseEffect();
 extern void matrix_regenerateMatrix();
+extern void matrix_reloadState();
 extern uint8 matrix_getOverflowLimit();
 extern uint8 matrix_getPositionX(uint8 axis);
 extern uint8 matrix_getPositionY(uint8 axis);
-extern void matrix_transposeMainMatrix();
-extern void matrix_permuteMatrix(MatrixElement* matrix[]);
+extern uint8 matrix_getSize();
+extern bool matrix_scrollViewport(uint8 i, uint8 j);
+extern uint8 matrix_getViewportOffset(uint8 pos, uint8 offset, uint8 before, uint8 after);
+extern uint8 matrix_getLastPivotRow();
+extern uint8 matrix_getLastPivotColumn();
+extern SpriteEntry* matrix_getCellEntry(uint8 i, uint8 j);
+extern void matrix_permuteMatrix();
+extern void matrix_shuffleBitboard(RngState* rng, BitboardRow* rows, uint8 height, uint8 width);
+extern void matrix_drawPermutation(RngState* rng, uint16* swaps, uint16 cells);
+extern void matrix_applyPermutation(BitboardRow* rows, uint8 height, uint8 width, const uint16* swaps);
 extern bool matrix_evalBitBlockOverflow();
+extern uint16 matrix_getBitBlockPattern(uint8 i, uint8 j);
+extern void matrix_refreshRowWindows(uint8 first, uint8 count);
+extern uint8 matrix_evalBitBlock(uint16 pattern);
+extern void matrix_selectBitBlockEvaluation(uint8 rule, uint8 shape);
+extern void matrix_loadBitBlockShape(uint8 shape);
+extern void matrix_computeOverflowMap(OverflowMap* map);
+extern void matrix_buildOverflowMap(const BitboardRow* rows, uint8 size, uint8 limit, OverflowMap* map);
+extern void matrix_buildOverflowMaps(const BitboardRow* rows, uint8 size, OverflowMap* maps);
+extern void matrix_buildRuleOverflowMaps(const BitboardRow* rows, uint8 size, OverflowMap* maps);
+extern void matrix_rebuildOverflowMaps();
+extern void matrix_updateOverflowMaps(uint8 i, uint8 j);
+extern void matrix_updateOverflowRegion(uint8 top, uint8 bottom, uint8 left, uint8 right);
+extern const OverflowMap* matrix_getOverflowMap();
+extern bool matrix_isOverflowPivot(uint8 i, uint8 j);
+extern uint16 matrix_countOverflows(const OverflowMap* map, uint8 size);
+extern uint8 matrix_findNearestOverflow(uint8 fromI, uint8 fromJ, MatrixPivot* nearest);
+extern uint8 matrix_getNearestInRow(OverflowRow row, uint8 j, uint8* nearestJ);
+extern uint8 matrix_getMoveCost(uint8 fromI, uint8 fromJ, uint8 toI, uint8 toJ);
+extern uint64 matrix_getRowWindows(BitboardRow row, uint8 size, uint8 first);
+extern uint8 matrix_gatherLaneVerdicts(uint64 lanes);
+extern void matrix_loadBitboard(Binary *base, BitboardRow *rows, uint8 size);
+extern void matrix_loadTiledBitboard(Binary *base, uint8 baseSize, BitboardRow *rows, uint8 height, uint8 width);
+extern Binary matrix_getBit(uint8 i, uint8 j);
+extern void matrix_setBit(uint8 i, uint8 j, Binary bit);
+extern void matrix_displayCell(uint8 sprite, Binary bit, uint8 i, uint8 j, bool hide);
+extern bool matrix_syncCell(Binary bit, uint8 i, uint8 j, uint8 offsetY, bool hide);
+extern void matrix_markViewDirty(uint8 row, ViewMask cols);
+extern void matrix_markRowsDirty(uint8 first, uint8 count);
+extern uint8 matrix_commitView();
 
-extern Binary baseMatrix[MATRIX_SIZE][MATRIX_SIZE];
-extern Binary baseBitBlockBuffer[BITBLOCK_SIZE][BITBLOCK_SIZE];
+extern Binary baseMatrix[MATRIX_BASE_SIZE][MATRIX_BASE_SIZE];
+extern Binary baseBitBlockBuffer[BITBLOCK_BASE_SIZE][BITBLOCK_BASE_SIZE];
+#if BITBLOCK_LOOKUP_TABLE
+extern const uint8 bitBlockRuleTables[][BITBLOCK_SHAPES][BITBLOCK_PATTERNS];
+extern const uint8* bitBlockTable;
+#endif
+extern const uint16 bitBlockShapeMasks[];
+extern const uint8 overflowRuleLimits[][BITBLOCK_SHAPES][OVERFLOW_MAPS];
 
-extern MatrixElement* matrix[MATRIX_SIZE][MATRIX_SIZE];
-extern MatrixElement* bitBlockBuffer[BITBLOCK_SIZE][BITBLOCK_SIZE];
+extern BitboardRow matrix[MATRIX_MAX_SIZE];
+extern uint8 rowWindows[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE];
+extern uint32 matrixGeneration;
+extern BitboardRow bitBlockBuffer[BITBLOCK_ROWS];
+extern uint8 matrixSprites[MATRIX_VIEW_SIZE][MATRIX_VIEW_SIZE];
+extern Binary matrixDigits[MATRIX_VIEW_SIZE][MATRIX_VIEW_SIZE];
+extern uint8 bitBlockSprites[BITBLOCK_ROWS][BITBLOCK_COLS];
 
 extern MatrixPivot* pivot;
+extern MatrixViewport viewport;
+extern uint8 matrixSize;
+extern OverflowMap overflowMaps[OVERFLOW_MAPS];
 extern bool isMatrixHidden;
 extern bool isBufferHidden;
-extern double binaryBase;
 #endif //INATRIX_OVERFLOW_MATRIX_H
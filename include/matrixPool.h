@@ -0,0 +1,162 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file matrixPool.h
+ */
+
+#ifndef INATRIX_OVERFLOW_MATRIXPOOL_H
+#define INATRIX_OVERFLOW_MATRIXPOOL_H
+
+#include "defines.h"
+#include "matrix.h"
+
+#define MATRIX_POOL_SIZE 4 // Potencia de 2, los índices del ring avanzan sin reiniciarse.
+#define MATRIX_POOL_INDEX(counter) ((counter) & (MATRIX_POOL_SIZE - 1))
+#define MATRIX_POOL_MAX_ATTEMPTS 8 // Intentos por matriz en el loop principal; dentro de la interrupción, 1.
+
+/**
+ * Barrera del compilador: las escrituras de una entrada no pueden moverse por detrás del avance
+ * del contador que la publica (ni las lecturas del consumidor por detrás del que la libera).
+ * El ARM946E-S no reordena accesos a memoria, así que basta con frenar al compilador.
+ * Fuera de este esquema queda @fn matrixPool_reset, que desde el loop principal escribe también los
+ * contadores del consumidor: lo hace con las interrupciones deshabilitadas (IME = 0).
+ */
+#define MATRIX_POOL_BARRIER() asm volatile("" ::: "memory")
+
+/**
+ * Profundidad del ring de bloques de bits de reemplazo (potencia de 2); se puede cambiar desde
+ * CFLAGS, p.ej. -DBITBLOCK_RING_SIZE=16.
+ */
+#ifndef BITBLOCK_RING_SIZE
+#define BITBLOCK_RING_SIZE 8
+#endif
+#define BITBLOCK_RING_INDEX(counter) ((counter) & (BITBLOCK_RING_SIZE - 1))
+
+#if (BITBLOCK_RING_SIZE & (BITBLOCK_RING_SIZE - 1)) || (BITBLOCK_RING_SIZE > 128)
+#error "BITBLOCK_RING_SIZE ha de ser una potencia de 2 no mayor que 128."
+#endif
+
+/**
+ * Bandas de densidad por defecto (número de pivots con overflow, ambos incluidos), por cada
+ * @def OVERFLOW_BAND_PIVOTS pivots (los de la matriz de 10x10 con el bloque de 3x3); se escalan al
+ * número de pivots de la sesión.
+ * Son las de la regla y la forma originales en @var overflowRuleBands, sacadas igual que las demás
+ * (percentiles 10 y 99). Con la matriz base, una permutación uniforme cae dentro de ambas ~85% de
+ * las veces.
+ */
+#define OVERFLOW_BAND_PIVOTS 64
+#define OVERFLOW_BAND_NM_MIN 42
+#define OVERFLOW_BAND_NM_MAX 56
+#define OVERFLOW_BAND_HM_MIN 7
+#define OVERFLOW_BAND_HM_MAX 21
+
+/**
+ * @struct OverflowBand
+ * @brief Rango admitido de pivots con overflow para una dificultad.
+ * @var min: mínimo (incluido).
+ * @var max: máximo (incluido).
+ */
+typedef struct {
+    uint16 min;
+    uint16 max;
+} OverflowBand;
+
+/**
+ * @struct MatrixPoolEntry
+ * @brief Matriz pre-generada, lista para sustituir a la actual.
+ * @var seed: estado del generador justo antes de generarla (con él se vuelve a generar idéntica).
+ * @var matrix: bitboard de la matriz principal.
+ * @var bitBlockBuffer: bitboard del buffer del bloque de bits.
+ * @var overflowMaps: mapas de overflow ya calculados, indexados por @enum Difficulty.
+ * @var rule: regla de overflow con la que se calcularon (@enum OverflowRule).
+ * @var shape: forma de selección con la que se calcularon (@enum BitBlockShape).
+ */
+typedef struct {
+    RngState seed;
+    BitboardRow matrix[MATRIX_MAX_SIZE];
+    BitboardRow bitBlockBuffer[BITBLOCK_ROWS];
+    OverflowMap overflowMaps[OVERFLOW_MAPS];
+    uint8 rule;
+    uint8 shape;
+} MatrixPoolEntry;
+
+/**
+ * @struct BitBlockRingEntry
+ * @brief Bloque de bits de reemplazo ya permutado.
+ * @var seed: estado del generador justo antes de generarlo.
+ * @var rows: bitboard del bloque, igual que @var bitBlockBuffer.
+ */
+typedef struct {
+    RngState seed;
+    BitboardRow rows[BITBLOCK_ROWS];
+} BitBlockRingEntry;
+
+/**
+ * @struct MatrixPoolStats
+ * @brief Contadores para comprobar que la regeneración nunca espera a la generación.
+ * @var generated: matrices generadas en el loop principal.
+ * @var consumed: matrices servidas desde el pool.
+ * @var misses: regeneraciones que han encontrado el pool vacío (y han tenido que generar ellas).
+ * @var rejected: matrices descartadas por quedar fuera de las bandas de densidad.
+ * @var outOfBand: matrices aceptadas fuera de banda al agotar @def MATRIX_POOL_MAX_ATTEMPTS.
+ * @var missesOutOfBand: matrices generadas en un fallo (un único intento) que han quedado fuera de banda.
+ * @var bitBlocksGenerated: bloques de bits generados para el ring.
+ * @var bitBlocksConsumed: bloques de bits servidos desde el ring.
+ * @var bitBlockMisses: bloques que han encontrado el ring vacío.
+ * @var minDepth: menor profundidad del pool observada al servir una matriz.
+ * @var lastRefillTicks: ticks entre la última extracción y su reposición.
+ * @var maxRefillTicks: máximo de @var lastRefillTicks.
+ */
+typedef struct {
+    uint32 generated;
+    uint32 consumed;
+    uint32 misses;
+    uint32 rejected;
+    uint32 outOfBand;
+    uint32 missesOutOfBand;
+    uint32 bitBlocksGenerated;
+    uint32 bitBlocksConsumed;
+    uint32 bitBlockMisses;
+    uint8 minDepth;
+    int lastRefillTicks;
+    int maxRefillTicks;
+} MatrixPoolStats;
+
+extern void matrixPool_init();
+extern void matrixPool_reset(RngState seed, RngState bitBlockSeed);
+extern RngState matrixPool_getNextSeed();
+extern RngState matrixPool_getNextBitBlockSeed();
+extern bool matrixPool_refillBitBlock();
+extern bool matrixPool_consumeBitBlock(BitboardRow* rows);
+extern uint8 matrixPool_getBitBlockDepth();
+extern void matrixPool_generateBitBlock(RngState* rng, BitboardRow* rows);
+extern bool matrixPool_refill();
+extern bool matrixPool_consume();
+extern uint8 matrixPool_getDepth();
+extern uint8 matrixPool_generateEntry(RngState* rng, MatrixPoolEntry* entry, uint8 attempts);
+extern bool matrixPool_isInBand(const OverflowMap* maps);
+extern void matrixPool_setOverflowBand(uint8 mode, uint16 min, uint16 max);
+extern void matrixPool_scaleOverflowBands(uint8 size);
+
+extern MatrixPoolStats matrixPoolStats;
+extern OverflowBand overflowBands[OVERFLOW_MAPS];
+extern const OverflowBand overflowRuleBands[][BITBLOCK_SHAPES][OVERFLOW_MAPS];
+#endif //INATRIX_OVERFLOW_MATRIXPOOL_H
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file matrixSnapshot.h
+ */
+
+#ifndef INATRIX_OVERFLOW_MATRIXSNAPSHOT_H
+#define INATRIX_OVERFLOW_MATRIXSNAPSHOT_H
+
+#include "defines.h"
+#include "matrix.h"
+#include "rng.h"
+
+/**
+ * Formato del registro. Cabecera de @def SNAPSHOT_HEADER_BYTES (16) bytes:
+ *  - byte 0: geometría del bloque (filas << 4 | columnas), para no restaurar el de otra compilación.
+ *  - byte 1: tamaño de la matriz.
+ *  - bytes 2 y 3: pivot (i, j).
+ *  - bytes 4-7, 8-11 y 12-15: estados de @var gameRng, del generador del pool de matrices y del
+ *    del ring de bloques (32 bits, little endian).
+ * Después, los bits de la matriz fila a fila y los del bitBlockBuffer, empaquetados sin huecos
+ * (columna 0 primero) y redondeados al byte. Con la matriz de 10x10 y el bloque de 3x3 son
+ * 16 + 14 = 30 bytes; con la de 32x32, 146. Los dos generadores del pool (8 bytes) son los que
+ * hacen falta para que las regeneraciones tras restaurar sean las mismas.
+ */
+#define SNAPSHOT_GEOMETRY 0
+#define SNAPSHOT_SIZE 1
+#define SNAPSHOT_PIVOT_I 2
+#define SNAPSHOT_PIVOT_J 3
+#define SNAPSHOT_GAME_RNG 4
+#define SNAPSHOT_POOL_RNG 8
+#define SNAPSHOT_BITBLOCK_RNG 12
+#define SNAPSHOT_HEADER_BYTES 16
+#define SNAPSHOT_GEOMETRY_ID ((BITBLOCK_ROWS << 4) | BITBLOCK_COLS)
+#define SNAPSHOT_BYTES(size) (SNAPSHOT_HEADER_BYTES + ((size) * (size) + BITBLOCK_CELLS + 7) / 8)
+#define SNAPSHOT_MAX_BYTES SNAPSHOT_BYTES(MATRIX_MAX_SIZE)
+
+/**
+ * @struct MatrixSnapshot
+ * @brief Estado completo de la matriz en un registro de tamaño fijo, sin punteros. Solo se usan
+ * los primeros @def SNAPSHOT_BYTES(size) bytes (30 en la matriz de 10x10), que son los que hay
+ * que guardar o transmitir.
+ * @var data: registro serializado.
+ */
+typedef struct {
+    uint8 data[SNAPSHOT_MAX_BYTES];
+} MatrixSnapshot;
+
+extern uint8 matrixSnapshot_save(MatrixSnapshot* snapshot);
+extern bool matrixSnapshot_restore(const MatrixSnapshot* snapshot);
+extern bool matrixSnapshot_isValid(const MatrixSnapshot* snapshot);
+extern void matrixSnapshot_writeBits(uint8* data, uint16* pos, BitboardRow value, uint8 bits);
+extern BitboardRow matrixSnapshot_readBits(const uint8* data, uint16* pos, uint8 bits);
+extern void matrixSnapshot_writeWord(uint8* data, uint32 value);
+extern uint32 matrixSnapshot_readWord(const uint8* data);
+#endif //INATRIX_OVERFLOW_MATRIXSNAPSHOT_H
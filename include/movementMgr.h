@@ -82,7 +82,7 @@ typedef struct{
 extern void movementMgr_allocateMovements(MovementGfx movGfx);
 extern void movementMgr_initSystem();
 extern void movementMgr_updateDirection(MovementGfx movGfx, Direction direction);
-extern int8 movementMgr_getMultiplier(Direction direction, uint8 posId);
+extern int8 movementMgr_getMultiplier(Direction direction, uint8 posId, uint8 lastPos);
 extern void movementMgr_movePosition(MovementGfx gfxMove);
 extern bool movementMgr_checkPosition(Direction direction, MovementGfx movGfx);
 extern bool movementMgr_nextPositionReached(MovementGfx movGfx);
@@ -0,0 +1,49 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file rng.h
+ */
+
+#ifndef INATRIX_OVERFLOW_RNG_H
+#define INATRIX_OVERFLOW_RNG_H
+
+#include "defines.h"
+
+#define RNG_DEFAULT_SEED 0x9E3779B9
+
+/**
+ * @struct RngState
+ * @brief Estado de un generador xorshift32. Cada sistema que necesite una secuencia
+ * independiente puede tener el suyo.
+ * @var state: estado interno, nunca puede ser 0.
+ */
+typedef struct {
+    uint32 state;
+} RngState;
+
+extern void rng_initSystem(uint32 seed);
+extern void rng_seed(RngState* rng, uint32 seed);
+extern uint32 rng_next(RngState* rng);
+extern uint32 rng_bounded(RngState* rng, uint32 bound);
+extern void rng_fill(RngState* rng, uint32* buffer, int size);
+
+extern RngState gameRng;
+#endif //INATRIX_OVERFLOW_RNG_H
@@ -36,9 +36,12 @@ extern void sprites_allocateMemory();
 extern void sprites_memorySetup(GfxData* gfx);
 extern void sprites_setNextMemoryAddress(GfxData* gfx);
 extern void sprites_createSprite(GfxData* gfx);
+extern void sprites_createSpriteView(uint8 index, GfxData* gfx);
 extern void sprites_reAllocateMemory(GfxData* gfxData, u16* memAddress);
 extern void sprites_dumpToMemory(GfxData* gfx);
 extern void sprites_displaySprite(uint8 index, int x, int y, bool isHidden);
+extern void sprites_setSprite(uint8 index, int x, int y, bool isHidden);
+extern void sprites_setSpriteGfx(uint8 index, GfxData* gfx, int x, int y, bool isHidden);
 extern void sprites_updateSprite(uint8 index);
 Sprite* sprites_getSpriteByIndex(uint8 index);
 SpriteEntry* sprites_getSpriteEntryByIndex(uint8 index);
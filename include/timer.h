@@ -30,6 +30,15 @@
 #define TIMER0_CNT  (*(vuint16*)0x04000102)
 #define TIMER0_DAT  (*(vuint16*)0x04000100)
 
+/**
+ * TIMER2 y TIMER3 en cascada forman un contador libre de 32 bits a la frecuencia del bus
+ * (33.513.982 Hz, 2 ciclos de CPU por cuenta; da la vuelta cada ~128 segundos). Sirve para medir.
+ */
+#define TIMER2_CNT  (*(vuint16*)0x0400010A)
+#define TIMER2_DAT  (*(vuint16*)0x04000108)
+#define TIMER3_CNT  (*(vuint16*)0x0400010E)
+#define TIMER3_DAT  (*(vuint16*)0x0400010C)
+
 #define TIMER0_FREQ 512
 #define EVENT_FREQ 100
 
@@ -59,6 +68,8 @@ void timer_DisableInterruptions();
 
 extern void timer_StartTimer();
 extern void timer_StopTimer();
+extern void timer_StartCycleCounter();
+extern uint32_t timer_ReadCycleCounter();
 extern bool timer_TicksHavePassed(int total, int prev);
 
 extern TimerData timer;
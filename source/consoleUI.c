@@ -35,7 +35,7 @@
 #include "consoleUI.h"
 #include "game.h"
 #include "matrix.h"
-#include "time.h"
+#include "rng.h"
 
 /**
  * @brief UI del menú principal, dando la posibilidad de que el
@@ -127,8 +127,10 @@ void consoleUI_showUI(){
     iprintf("\x1b[12;00H  Total: %i  ||  Current: %i  ", playerData.overflowScore, playerData.runOverflows);
     iprintf("\x1b[13;00H                            ");
     iprintf("\x1b[14;00H                            ");
-    iprintf("\x1b[15;00H  Mode: %s (Ovf@ %i)       ", gameData.mode == DIFFICULTY_NORMAL_MODE ? nm : hm, gameData.mode == DIFFICULTY_HARD_MODE ? OVERFLOW_HM : OVERFLOW_NM);
+    iprintf("\x1b[15;00H  Mode: %s (Ovf@ %i)       ", gameData.mode == DIFFICULTY_NORMAL_MODE ? nm : hm, matrix_getOverflowLimit());
     iprintf("\x1b[16;00H                            ");
+    if(gameData.hint)
+        consoleUI_showHint();
     iprintf("\x1b[17;00H                            ");
     iprintf("\x1b[18;00H  Matrix regenerations:  %i  ", gameData.matrixRegens);
     iprintf("\x1b[19;00H                            ");
@@ -136,6 +138,26 @@ void consoleUI_showUI(){
     iprintf("\x1b[21;00H ___________________________");
 }
 
+/**
+ * @brief Pista del UI: cuántos movimientos de cada eje faltan hasta el pivot con overflow más
+ * cercano (@fn matrix_findNearestOverflow). Se calcula cada vez que se pinta el UI, así que
+ * nunca queda desactualizada más allá del siguiente refresco.
+ */
+void consoleUI_showHint(){
+    MatrixPivot nearest;
+    int di, dj;
+
+    if(matrix_findNearestOverflow(pivot->i, pivot->j, &nearest) == HINT_NONE){
+        iprintf("\x1b[16;00H  Hint: no overflows left    ");
+        return;
+    }
+
+    di = nearest.i - pivot->i;
+    dj = nearest.j - pivot->j;
+    iprintf("\x1b[16;00H  Hint: %i %s, %i %s      ", di < 0 ? -di : di, di < 0 ? "up" : "down",
+            dj < 0 ? -dj : dj, dj < 0 ? "left" : "right");
+}
+
 /**
  * @brief Menú para el Game Over
  */
@@ -203,9 +225,8 @@ void consoleUI_showFail(){
     char f1[] = "\x1b[10;00H 'Me he columpiao!'";
     char f2[] = "\x1b[10;00H 'Socorroooo!'";
 
-    srand(time(0));
     iprintf("\x1b[2J");
-    iprintf(rand() % 2 == 0 ? f1 : f2);
+    iprintf(rng_bounded(&gameRng, 2) == 0 ? f1 : f2);
     iprintf("\x1b[12;00H   _");
     iprintf("\x1b[13;00H -Inatrix, Lord of the");
     iprintf("\x1b[15;00H  Overflow ");
@@ -291,7 +312,7 @@ void consoleUI_showControls(){
     iprintf("\x1b[13;00H |                           |");
     iprintf("\x1b[14;00H |                           |");
     iprintf("\x1b[15;00H |  <A> - Select BitBlock    |");
-    iprintf("\x1b[16;00H |                           |");
+    iprintf("\x1b[16;00H |  <R> - Hint on/off        |");
     iprintf("\x1b[17;00H |  <START> Pause            |");
     iprintf("\x1b[18;00H |                           |");
     iprintf("\x1b[19;00H |  <SELECT><B> Surrender    |");
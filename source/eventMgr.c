@@ -28,363 +28,389 @@
 
 #include "eventMgr.h"
 #include "timer.h"
-#include "backgrounds.h"
 #include "sprites.h"
 #include "nds.h"
 #include "game.h"
 #include "matrix.h"
 #include "movementMgr.h"
 #include "objectMgr.h"
-#include "consoleUI.h"
 
 /**
- * @var eventList[MAX_EVENTS]: Array que contiene punteros a structs @struct Event.
- * Ésta lista contendrá únicamente los eventos que han de ejecutarse aún.
+ * @var eventReady: Cola con los eventos ya vencidos que han de ejecutarse aún; los que faltan por
+ * vencer esperan en la rueda (@var eventWheel). @fn eventMgr_UpdateScheduledEvents la consume
+ * siempre por la cabeza, así que programar o cancelar eventos mientras se ejecuta uno no hace que
+ * se salte ninguno.
  */
-Event* eventList[MAX_EVENTS];
-int numEvents;
+EventQueue eventReady;
+
+/**
+ * @var eventPool[EVENT_POOL_SIZE]: Huecos para los eventos. Programar y borrar eventos ocurre
+ * continuamente dentro de la rutina de atención del timer, así que en vez de reservar memoria en el
+ * heap cada evento ocupa un hueco de este vector.
+ * @var eventFreeList: Primer hueco libre; los huecos libres se encadenan por @var next, de manera
+ * que obtener o devolver uno es sacar o meter en la cabeza de la lista.
+ * @var eventPoolStats: Contadores de uso del pool.
+ */
+Event eventPool[EVENT_POOL_SIZE];
+Event* eventFreeList;
+EventPoolStats eventPoolStats;
+
+/**
+ * @var eventWheel[EVENT_WHEEL_LEVELS][EVENT_WHEEL_SLOTS]: Rueda de tiempo jerárquica con los eventos
+ * pendientes. Un evento que vence dentro de menos de EVENT_WHEEL_SPAN(l + 1) ticks va al nivel l,
+ * en el hueco que indican los bits de su instante de ejecución correspondientes a ese nivel. Cada vez
+ * que el nivel l da la vuelta se reparte (@fn eventMgr_CascadeWheel) el siguiente hueco del nivel
+ * l + 1 entre los niveles inferiores, y en cada tick vence entero el hueco actual del
+ * nivel 0. Así programar y vencer un evento cuesta O(1) (amortizado: un evento baja como mucho
+ * @def EVENT_WHEEL_LEVELS veces) y un tick sin nada que vencer mira un único hueco, haya los
+ * eventos pendientes que haya.
+ * @var eventWheelOccupied[EVENT_WHEEL_LEVELS]: Huecos no vacíos de cada nivel (bit s = hueco s).
+ * Permiten saltar de golpe los tramos en los que no vence ni se reparte nada (p.ej. tras una pausa).
+ * @var eventWheelTime: Tick hasta el que ha avanzado la rueda; todo lo que vence en él o antes
+ * está ya en @var eventReady.
+ */
+EventQueue eventWheel[EVENT_WHEEL_LEVELS][EVENT_WHEEL_SLOTS];
+uint64 eventWheelOccupied[EVENT_WHEEL_LEVELS];
+int eventWheelTime;
+
+/**
+ * @var eventHandlers[EVENTS_SIZE]: Función de cada evento, indexada por su ID. Los módulos las
+ * registran al arrancar (ver @fn gameEvents_registerHandlers), así que ejecutar un evento es un
+ * acceso a la tabla y una llamada, haya los eventos que haya; añadir uno no toca el eventMgr.
+ * @var eventHandlerStats[EVENTS_SIZE]: Contadores de cada función, por ID de evento.
+ */
+EventHandler eventHandlers[EVENTS_SIZE];
+EventHandlerStats eventHandlerStats[EVENTS_SIZE];
 
 #ifdef DEBUG_MODE
 int lineDelete = 8;
-int lineAdd = 0;
 #endif
 void eventMgr_InitEventSystem(){
-    numEvents = 0;
+    eventReady.head = eventReady.tail = NULL;
+
+    eventFreeList = NULL;
+    for(int i = EVENT_POOL_SIZE - 1; i >= 0; i--){
+        eventPool[i].gen = 0;
+        eventPool[i].next = eventFreeList;
+        eventFreeList = &eventPool[i];
+    }
+    eventPoolStats.inUse = eventPoolStats.peak = 0;
+    eventPoolStats.acquired = eventPoolStats.failed = 0;
+
+    for(int level = 0; level < EVENT_WHEEL_LEVELS; level++){
+        for(int slot = 0; slot < EVENT_WHEEL_SLOTS; slot++)
+            eventWheel[level][slot].head = eventWheel[level][slot].tail = NULL;
+        eventWheelOccupied[level] = 0;
+    }
+    eventWheelTime = timer.totalTicks;
+
+    for(int id = 0; id < EVENTS_SIZE; id++){
+        eventHandlers[id] = NULL;
+        eventHandlerStats[id].calls = eventHandlerStats[id].cycles = eventHandlerStats[id].maxCycles = 0;
+    }
 }
+
 /**
- * @brief Función para borrar un evento en concreto de la lista.
- * Reorganizar el array en base al evento borrado
- * Liberar memoria del puntero al evento.
- * @param event puntero al @struct Event
+ * @brief Registra la función que se ejecuta cuando vence un evento, sustituyendo a la anterior.
+ * @param eventId ID del evento (@enum Events).
+ * @param handler Función a ejecutar, o NULL para que el evento se descarte al vencer.
  */
-void eventMgr_DeleteEvent(Event *event){
-    uint8 i = event->pos;
+void eventMgr_RegisterHandler(uint8 eventId, EventHandler handler){
+    if(eventId < EVENTS_SIZE)
+        eventHandlers[eventId] = handler;
+}
 
-#ifdef DEBUG_MODE
-    iprintf("\x1b[%i;00H [DEL] NE: %i e.pos: %i - e.id: %i", lineDelete, numEvents, event->pos, event->id);
-    lineDelete += 1;
-#endif // DEBUG_MODE
+/**
+ * @brief Obtiene un hueco libre del pool de eventos, en tiempo constante y sin usar el heap.
+ * Se llama tanto desde el loop principal como desde la rutina de atención del timer, así que
+ * la lista de huecos libres se toca con las interrupciones deshabilitadas.
+ * @return Puntero al evento, o NULL si el pool está lleno.
+ */
+Event* eventMgr_AcquireEvent(){
+    uint32 ime = IME;
+    Event* event;
 
-    while ((i < numEvents) && (eventList[i] != NULL))
-    {
-        eventList[i] = eventList[i+1];
-        eventList[i]->pos = i;
-        i++;
+    IME = 0;
+    event = eventFreeList;
+    if(event != NULL){
+        eventFreeList = event->next;
+        event->next = NULL;
+        event->cancelled = false;
+        eventPoolStats.acquired++;
+        if(++eventPoolStats.inUse > eventPoolStats.peak)
+            eventPoolStats.peak = eventPoolStats.inUse;
     }
+    else
+        eventPoolStats.failed++;
+    IME = ime;
 
-    free(event);
-    numEvents--;
-#ifdef DEBUG_MODE
-    iprintf("\x1b[%i;00H [ARRAY] ={%i, %i, %i, %i}", lineDelete+6, eventList[0]->id, eventList[1]->id,eventList[2]->id,eventList[3]->id);
-    lineDelete += 1;
-#endif // DEBUG_MODE
+    return event;
 }
 
 /**
- * @brief Agrega un evento a la lista para ser ejecutado.
+ * @brief Devuelve al pool el hueco de un evento ya ejecutado o cancelado, en tiempo constante.
+ * Cambia la generación del hueco para invalidar su @typedef EventHandle.
+ * @param event puntero al @struct Event, obtenido con @fn eventMgr_AcquireEvent.
+ */
+void eventMgr_ReleaseEvent(Event* event){
+    uint32 ime = IME;
+
+    IME = 0;
+    event->gen++;
+    event->next = eventFreeList;
+    eventFreeList = event;
+    eventPoolStats.inUse--;
+    IME = ime;
+}
+/**
+ * @brief Añade un evento al final de una cola.
+ * @param queue Cola destino.
  * @param event puntero al @struct Event
  */
-void eventMgr_AddEvent(Event *event){
-    if(numEvents < MAX_EVENTS)
-    {
-        eventList[numEvents] = event;
-        event->pos = numEvents;
-        numEvents++;
-#ifdef DEBUG_MODE
-        iprintf("\x1b[%i;00H [ADD] NE: %i e.pos: %i - e.id: %i", lineAdd, numEvents, event->pos, event->id);
-        lineAdd += 1;
-#endif // DEBUG_MODE
+void eventMgr_QueuePush(EventQueue* queue, Event* event){
+    event->next = NULL;
+    if(queue->head == NULL)
+        queue->head = event;
+    else
+        queue->tail->next = event;
+    queue->tail = event;
+}
+
+/**
+ * @brief Coloca un evento en la rueda según lo que le falta para vencer. Si ya ha vencido pasa
+ * directamente a @var eventReady. Los eventos más allá de
+ * @def EVENT_WHEEL_HORIZON se colocan en el último hueco alcanzable y se recolocan al repartirlo.
+ * @param event puntero al @struct Event, con @var execTime ya fijado.
+ */
+void eventMgr_WheelInsert(Event* event){
+    int delta = event->execTime - eventWheelTime;
+    int slotTime = event->execTime;
+    uint8 level = 0;
+    uint8 slot;
+
+    if(delta <= 0){
+        eventMgr_QueuePush(&eventReady, event);
+        return;
     }
+
+    if(delta >= EVENT_WHEEL_HORIZON)
+        slotTime = eventWheelTime + EVENT_WHEEL_HORIZON - 1;
+    while(level < EVENT_WHEEL_LEVELS - 1 && (slotTime - eventWheelTime) >= EVENT_WHEEL_SPAN(level + 1))
+        level++;
+
+    slot = (slotTime >> (EVENT_WHEEL_BITS * level)) & EVENT_WHEEL_MASK;
+    eventMgr_QueuePush(&eventWheel[level][slot], event);
+    eventWheelOccupied[level] |= ((uint64) 1) << slot;
 }
 
 /**
- * @brief Función que elimina todos los eventos de la lista.
+ * @brief Reparte un hueco de un nivel superior de la rueda: sus eventos vencen dentro de menos de
+ * EVENT_WHEEL_SPAN(level) ticks, así que se vuelven a colocar en los niveles inferiores.
+ * @param level Nivel (mayor que 0).
+ * @param slot Hueco del nivel.
+ */
+void eventMgr_CascadeWheel(uint8 level, uint8 slot){
+    Event* event = eventWheel[level][slot].head;
+
+    eventWheel[level][slot].head = eventWheel[level][slot].tail = NULL;
+    eventWheelOccupied[level] &= ~(((uint64) 1) << slot);
+    while(event != NULL){
+        Event* next = event->next;
+
+        eventMgr_WheelInsert(event);
+        event = next;
+    }
+}
+
+/**
+ * @brief Avanza la rueda hasta el instante dado, tick a tick: en cada uno se reparten los huecos
+ * de los niveles que dan la vuelta y vence el hueco actual del nivel 0 (se engancha entero a
+ * @var eventReady). Si los niveles inferiores están vacíos, hasta la siguiente vuelta del primer
+ * nivel ocupado no puede pasar nada y se salta directamente ahí. Si la rueda ya está al día no hace
+ * nada.
+ * @param now Instante actual, en ticks.
+ */
+void eventMgr_AdvanceWheel(int now){
+    while(eventWheelTime < now){
+        uint8 level = 0;
+        EventQueue* slot;
+
+        while(level < EVENT_WHEEL_LEVELS && eventWheelOccupied[level] == 0)
+            level++;
+        if(level == EVENT_WHEEL_LEVELS){
+            eventWheelTime = now;
+            break;
+        }
+        if(level > 0){
+            int skipTo = (eventWheelTime | (EVENT_WHEEL_SPAN(level) - 1)) + 1;
+
+            if(skipTo > now){
+                eventWheelTime = now;
+                break;
+            }
+            eventWheelTime = skipTo - 1;
+        }
+
+        eventWheelTime++;
+        level = 1;
+        while(level < EVENT_WHEEL_LEVELS && (eventWheelTime & (EVENT_WHEEL_SPAN(level) - 1)) == 0)
+            level++;
+        while(--level > 0)
+            eventMgr_CascadeWheel(level, (eventWheelTime >> (EVENT_WHEEL_BITS * level)) & EVENT_WHEEL_MASK);
+
+        slot = &eventWheel[0][eventWheelTime & EVENT_WHEEL_MASK];
+        if(slot->head != NULL){
+            if(eventReady.head == NULL)
+                eventReady.head = slot->head;
+            else
+                eventReady.tail->next = slot->head;
+            eventReady.tail = slot->tail;
+            slot->head = slot->tail = NULL;
+            eventWheelOccupied[0] &= ~(((uint64) 1) << (eventWheelTime & EVENT_WHEEL_MASK));
+        }
+    }
+}
+
+/**
+ * @brief Devuelve al pool todos los eventos de una cola y la vacía.
+ * @param queue Cola a vaciar.
+ */
+void eventMgr_ReleaseQueue(EventQueue* queue){
+    Event* event = queue->head;
+
+    while(event != NULL){
+        Event* next = event->next;
+
+        eventMgr_ReleaseEvent(event);
+        event = next;
+    }
+    queue->head = queue->tail = NULL;
+}
+
+/**
+ * @brief Cancela un evento programado, en tiempo constante. No se saca de la cola en la que esté
+ * (la rueda o @var eventReady): se marca y se devuelve al pool sin ejecutarse cuando se llegue a él.
+ * Se puede llamar desde un evento en ejecución, incluso con su propio identificador.
+ * @param handle Identificador devuelto por @fn eventMgr_ScheduleEvent.
+ * @return TRUE si el evento estaba pendiente - FALSE si ya se había ejecutado o cancelado.
+ */
+bool eventMgr_CancelEvent(EventHandle handle){
+    uint16 index = (handle & 0xFFFF) - 1;
+    bool pending = false;
+    uint32 ime = IME;
+
+    if(handle == EVENT_HANDLE_NONE || index >= EVENT_POOL_SIZE)
+        return false;
+
+    IME = 0;
+    if(eventPool[index].gen == (handle >> 16) && !eventPool[index].cancelled){
+        eventPool[index].cancelled = true;
+        pending = true;
+    }
+    IME = ime;
+
+    return pending;
+}
+
+/**
+ * @brief Función que elimina todos los eventos vencidos y los pendientes de la rueda. Si se llama
+ * desde un evento en ejecución, ése se devuelve al pool al terminar (ver
+ * @fn eventMgr_UpdateScheduledEvents).
  */
 void eventMgr_cancelAllEvents(){
-    for (int i = 0; i < numEvents; i++)
-        eventMgr_DeleteEvent(eventList[i]);
+    uint32 ime = IME;
+
+    IME = 0;
+    eventMgr_ReleaseQueue(&eventReady);
+    for(int level = 0; level < EVENT_WHEEL_LEVELS; level++){
+        for(int slot = 0; slot < EVENT_WHEEL_SLOTS; slot++)
+            eventMgr_ReleaseQueue(&eventWheel[level][slot]);
+        eventWheelOccupied[level] = 0;
+    }
+    IME = ime;
 }
 /**
  * @brief Función "Pública" que es la que realmente se utiliza fuera del eventMgr
  * para poder programar eventos en el tiempo.
  * @param eventId ID del evento
- * @param time Cuando el evento ha de ser ejecutado (con respecto al instante en el que se programe )
+ * @param time Cuando el evento ha de ser ejecutado (con respecto al instante en el que se programe ),
+ * en ticks: @enum TimeMarks, EVENT_MS o EVENT_SECONDS. Se ejecuta en el primer tick en el que se
+ * cumple el plazo, así que el retardo es exacto desde la rutina de atención del timer y, desde el
+ * loop principal, como mucho un tick mayor.
+ * @return Identificador para cancelarlo con @fn eventMgr_CancelEvent, o EVENT_HANDLE_NONE si el
+ * pool está lleno y no se ha programado.
  */
-void eventMgr_ScheduleEvent(uint8 eventId, int time){
+EventHandle eventMgr_ScheduleEvent(uint8 eventId, int time){
     /*
-     * Geru: Reservo memoria dinámica en el heap, porque el stack se vacía
-     * Una vez terminado el scope de la función, y queremos que persistan.
-     * Importante liberar la memoria reservada correspondiente a cada evento.
+     * Los eventos han de persistir una vez terminado el scope de la función, pero
+     * en vez de reservarlos en el heap se sacan del pool (ver @var eventPool).
+     * Se devuelven al pool tras ejecutarse, ver @fn eventMgr_UpdateScheduledEvents.
+     * La rueda también la avanza la rutina de atención del timer, así que se toca
+     * con las interrupciones deshabilitadas.
      */
-    if(numEvents < MAX_EVENTS) {
-        Event* e = malloc(sizeof(Event));
+    Event* e = eventMgr_AcquireEvent();
+
+    if(e != NULL) {
+        uint32 ime = IME;
+        EventHandle handle;
+
         e->id = eventId;
-        e->execTime = timer.time + time;
-        eventMgr_AddEvent(e);
+        e->execTime = timer.totalTicks + time;
+        IME = 0;
+        eventMgr_WheelInsert(e);
+        // Con las interrupciones ya habilitadas, un evento NO_WAIT podría ejecutarse, devolverse
+        // al pool y reutilizarse antes de leer su generación.
+        handle = ((EventHandle) e->gen << 16) | (EventHandle) (e - eventPool + 1);
+        IME = ime;
+
+        return handle;
     }
+
+    return EVENT_HANDLE_NONE;
 }
 
 /**
- * @brief Función principal del eventMgr, que se encarga de ir comprobando
- * si alguno de los eventos almacenados en la lista ha de ser ejecutado.
- * Si efectivamente ha de ejecutarse, entonces se gestiona como se considere
- * oportuno.
+ * @brief Función principal del eventMgr, que se encarga de ejecutar los eventos
+ * que ya han vencido, llamando a la función registrada para cada uno (@var eventHandlers).
  *
  * Aquí es donde se va a desarrollar secuencialmente el juego. Separando el "guión"
- * de la lógica.
+ * (ver gameEvents.c) de la lógica.
  *
  * En la cadena de llamadas propiciada por la interrupción del timer, esta función
- * será invocada.
+ * será invocada. Antes se avanza la rueda (@fn eventMgr_AdvanceWheel), que deja en
+ * @var eventReady únicamente los eventos vencidos: un tick sin nada que vencer no recorre nada.
+ * Cada evento se saca de la cola antes de ejecutarlo y se devuelve al pool después, así que lo
+ * que haga (programar, cancelar o cancelar todos) nunca deja atrás a otro evento vencido.
+ * Lo que tarda cada función se acumula en @var eventHandlerStats.
  */
 void eventMgr_UpdateScheduledEvents(){
-    if(numEvents == 0 || gameData.state == GAME_STATE_PAUSE)
+    Event* event;
+
+    if(gameData.state == GAME_STATE_PAUSE)
         return;
-    for (int i = 0; i < numEvents; i++)
+
+    eventMgr_AdvanceWheel(timer.totalTicks);
+    while((event = eventReady.head) != NULL)
     {
-        if(eventList[i]->execTime <= timer.time)
+        eventReady.head = event->next;
+        if(!event->cancelled && event->id < EVENTS_SIZE && eventHandlers[event->id] != NULL)
         {
-            switch(eventList[i]->id)
-            {
-                /*
-                *********************
-                *********************
-                ***** MAIN MENU *****
-                *********************
-                *********************
-                */
-                case EVENT_MAIN_MENU_START:
-                    consoleUI_showMenu();
-                    gameData.phase = PHASE_SHOW_MENU;
-                    eventMgr_ScheduleEvent(EVENT_MAIN_MENU_HIDE_UI, IN_1_SECONDS);
-                    break;
-                case EVENT_MAIN_MENU_HIDE_UI:
-                    if(gameData.phase == PHASE_SHOW_MENU) {
-                        iprintf("\x1b[9;00H |                           |");
-                        eventMgr_ScheduleEvent(EVENT_MAIN_MENU_SHOW_UI, IN_1_SECONDS);
-                    }
-                    break;
-                case EVENT_MAIN_MENU_SHOW_UI:
-                    if(gameData.phase == PHASE_SHOW_MENU) {
-                        iprintf("\x1b[9;00H |  <PRESS START TO BEGIN>   |");
-                        eventMgr_ScheduleEvent(EVENT_MAIN_MENU_HIDE_UI, IN_1_SECONDS);
-                    }
-                    break;
-                case EVENT_SHOW_CONTROLS:
-                    gameData.phase = PHASE_SHOW_CONTROLS;
-                    consoleUI_showControls();
-                    break;
-                case EVENT_SHOW_GAMEPLAY:
-                    gameData.phase = PHASE_SHOW_GAMEPLAY;
-                    consoleUI_showGameplay();
-                    break;
-                case EVENT_SHOW_LORE:
-                    gameData.phase = PHASE_SHOW_LORE;
-                    consoleUI_showLore();
-                    break;
-                case EVENT_SHOW_LORE_2:
-                    gameData.phase = PHASE_SHOW_LORE_2;
-                    consoleUI_showLore2();
-                    break;
-                /*
-                *********************
-                *********************
-                ******* INTRO *******
-                *********************
-                *********************
-                */
-                case EVENT_INTRO_PRE_START:
-                    background_setBackground(BG_MATRIX);
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, NO_WAIT);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_START, IN_4_SECONDS);
-                    break;
-                case EVENT_INTRO_START:
-                    iprintf("\x1b[09;10H _");
-                    iprintf("\x1b[10;00H Wake up, Inatrix...");
-                    background_setBackground(BG_MATRIX_INATRIX);
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT1, IN_4_SECONDS);
-                    break;
-                case EVENT_INTRO_TEXT1:
-                    iprintf("\x1b[10;00H The Matrix has you...");
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT2, IN_5_SECONDS);
-                    break;
-                case EVENT_INTRO_TEXT2:
-                    iprintf("\x1b[10;00H Follow the white rabbit.");
-                    background_setBackground(BG_RABBIT);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT3, IN_5_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_RABBIT2, IN_3_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
-                    break;
-                case EVENT_INTRO_RABBIT2:
-                    background_setBackground(BG_RABBIT2);
-                    break;
-                case EVENT_INTRO_TEXT3:
-                    iprintf("\x1b[09;15H _");
-                    iprintf("\x1b[10;00H Knock, knock, Inatrix.");
-                    background_setBackground(BG_RABBIT3);
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT4, IN_4_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_SETBG_3, IN_3_SECONDS);
-                    break;
-                case EVENT_INTRO_TEXT4:
-                    iprintf("\x1b[10;00H So, blue pill or red pill?");
-                    iprintf("\x1b[20;00H Blue - Normal");
-                    iprintf("\x1b[20;18H Red - Hard");
-                    eventMgr_ScheduleEvent(EVENT_INTRO_SHOW_CAPSULES, IN_2_SECONDS);
-                    break;
-                case EVENT_INTRO_SHOW_CAPSULES:
-                    objectMgr_spawnCapsules();
-                    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
-                    break;
-                case EVENT_INTRO_CAPSULE_SELECTED:
-                    iprintf("\x1b[2J");
-                    char ht1[] = "\x1b[10;00H I see... good choice.";
-                    char nt1[] = "\x1b[10;00H You are weak.";
-                    iprintf(gameData.mode == DIFFICULTY_HARD_MODE ? ht1 : nt1);
-                    objectMgr_manageSelectedCapsule(gameData.mode);
-                    gameData.phase = PHASE_MOVE_CAPSULE;
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_2_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_FINISH1, IN_4_SECONDS); // Ojo, algo más introductorio rollo into the matrix.
-                    break;
-                case EVENT_INTRO_FINISH1:
-                    char ht2[] = "\x1b[10;00H or not? hahaha...";
-                    char nt2[] = "\x1b[10;00H You will be lost in the Matrix";
-                    iprintf(gameData.mode == DIFFICULTY_HARD_MODE ? ht2 : nt2);
-                    objectMgr_manageSelectedCapsule(gameData.mode == DIFFICULTY_NORMAL_MODE ? GFX_CAPSULE_RED : GFX_CAPSULE_BLUE);
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_INTRO_FINISH2, IN_4_SECONDS);
-                    break;
-                case EVENT_INTRO_FINISH2:
-                    consoleUI_showIntro1();
-                    objectMgr_spawnInatrix();
-                    eventMgr_ScheduleEvent(EVENT_GAME_START, IN_4_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
-                    break;
-                /*
-                *********************
-                *********************
-                ******* GAME ********
-                *********************
-                *********************
-                */
-                case EVENT_GAME_START:
-                    gameData.state = GAME_STATE_GAME;
-                    matrix_displayMatrix(true);
-                    consoleUI_showIntro2();
-                    eventMgr_ScheduleEvent(EVENT_GAME_START_DEST_MATRIX, IN_4_SECONDS);
-                    eventMgr_ScheduleEvent(EVENT_GAME_UI_SHOW_BASE, IN_4_SECONDS);
-                    break;
-                case EVENT_GAME_START_DEST_MATRIX:
-                    game_enableDestroyMatrix();
-                    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
-                    eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
-                    break;
-                case EVENT_GAME_DESTROY_MATRIX_CHECK:
-                    if(gameData.destroyMatrixActive){
-                        gameData.destroyMatrixTime -= 1;
-                        consoleUI_showUI();
-                        if(gameData.destroyMatrixTime <= 0){
-                            if(game_achievedMinimumOverflows()){
-                                game_setDestroyMatrix(false);
-                                eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX, NO_WAIT);
-                            }
-                            else
-                            {
-                                game_manageGameOver(false);
-                                return;
-                            }
-                        }
-                        eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
-                    }
-                    break;
-                case EVENT_GAME_DROP_BITBLOCK:
-                    gameData.phase = PHASE_BITBLOCK_FALLING;
-                    break;
-                case EVENT_GAME_REGENERATE_BITBLOCK:
-                    matrix_regenerateBitBlock();
-                    game_setDestroyMatrix(true);
-                    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
-                    eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
-                    break;
-                case EVENT_GAME_HIDE_MATRIX:
-                    gameData.phase = PHASE_REGENERATING_MATRIX;
-                    matrix_displayMatrix(false);
-                    eventMgr_ScheduleEvent(EVENT_GAME_REGENERATE_MATRIX, IN_5_SECONDS);
-                    break;
-                case EVENT_GAME_REGENERATE_MATRIX:
-                    matrix_regenerateMatrix();
-                    matrix_displayMatrix(true);
-                    game_enableDestroyMatrix();
-                    game_setDestroyMatrix(true);
-                    game_increaseMatrixRegens();
-                    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
-                    eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
-                    break;
-                case EVENT_GAME_DESTROY_MATRIX:
-                    consoleUI_showRegeneratingMatrix();
-                    gameData.phase = PHASE_DESTROYING_MATRIX;
-                    break;
-                case EVENT_GAME_INATRIX_MOVE_X:
-                    movementMgr_movePosition(MOVEMENT_INATRIX_X);
-                    objectMgr_setAnimationActive(ANIMATION_BIT_SHAKE, false);
-                    gameData.phase = PHASE_MOVE_INATRIX_X;
-                    break;
-                case EVENT_GAME_INATRIX_MOVE_Y:
-                    movementMgr_movePosition(MOVEMENT_INATRIX_Y);
-                    objectMgr_setAnimationActive(ANIMATION_BIT_SHAKE, false);
-                    gameData.phase = PHASE_MOVE_INATRIX_Y;
-                    break;
-                case EVENT_GAME_EVALUATE_BITBLOCK:
-                    objectMgr_setAnimationActive(ANIMATION_BIT_SHAKE, false);
-                    bool ovf = matrix_evalBitBlockOverflow();
-                    if(!game_manageScore(ovf))
-                        break;
-                    if(ovf){
-                        game_setDestroyMatrix(false);
-                        consoleUI_showOverflow();
-                        eventMgr_ScheduleEvent(EVENT_GAME_UI_SHOW_BASE, IN_4_SECONDS);
-                    }else{
-                        game_setDestroyMatrix(false);
-                        consoleUI_showFail();
-                        eventMgr_ScheduleEvent(EVENT_GAME_UI_SHOW_BASE, IN_5_SECONDS);
-                    }
-                    eventMgr_ScheduleEvent(EVENT_GAME_DROP_BITBLOCK, IN_2_SECONDS);
-                    break;
-                case EVENT_GAME_UI_SHOW_BASE:
-                    game_setDestroyMatrix(true);
-                    consoleUI_showUI();
-                    break;
-                case EVENT_INTRO_SETBG_MAIN:
-                    background_setBackground(BG_MAIN);
-                    break;
-                case EVENT_INTRO_SETBG_2:
-                    background_setBackground(BG_MATRIX);
-                    break;
-                case EVENT_INTRO_SETBG_3:
-                    background_setBackground(BG_MATRIX2);
-                    break;
-                case EVENT_CLEAR_CONSOLE:
-                    iprintf("\x1b[2J");
-                    break;
-                case EVENT_SHOW_STATS:
-                    consoleUI_showStats();
-                    gameData.state = GAME_STATE_STATS;
-                    gameData.phase = PHASE_SHOW_STATS;
-                    break;
-                case EVENT_LISTEN_INPUT:
-                    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
-                    break;
-                case EVENT_GAME_PAUSE:
-                    gameData.state = GAME_STATE_PAUSE;
-                    gameData.phase = PHASE_GAME_PAUSE;
-                    consoleUI_showPauseUI();
-                    break;
-                default:
-                    break;
-            }
-            eventMgr_DeleteEvent(eventList[i]);
+            EventHandlerStats* stats = &eventHandlerStats[event->id];
+            uint32 start = timer_ReadCycleCounter();
+            uint32 cycles;
+
+            eventHandlers[event->id]();
+            cycles = timer_ReadCycleCounter() - start;
+            stats->calls++;
+            stats->cycles += cycles;
+            if(cycles > stats->maxCycles)
+                stats->maxCycles = cycles;
         }
+#ifdef DEBUG_MODE
+        iprintf("\x1b[%i;00H [DEL] e.id: %i", lineDelete, event->id);
+        lineDelete += 1;
+#endif // DEBUG_MODE
+        eventMgr_ReleaseEvent(event);
     }
 }
 
@@ -408,6 +434,22 @@ void eventMgr_UpdatePhases(){
                 gameData.phase = PHASE_NULL;
             }
             break;
+        case PHASE_BITBLOCK_COLLAPSING:
+            if(!matrix_collapseEffect()){
+                game_setDestroyMatrix(true);
+                gameData.phase = PHASE_WAITING_PLAYER_INPUT;
+                eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
+            }
+            break;
+        case PHASE_REVEALING_MATRIX:
+            if(!matrix_revealMatrixEffect()){
+                game_enableDestroyMatrix();
+                game_setDestroyMatrix(true);
+                game_increaseMatrixRegens();
+                gameData.phase = PHASE_WAITING_PLAYER_INPUT;
+                eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
+            }
+            break;
         case PHASE_DESTROYING_MATRIX:
             if(!matrix_destroyMatrixEffect()){
                 eventMgr_ScheduleEvent(EVENT_GAME_REGENERATE_MATRIX, IN_3_SECONDS);
@@ -438,6 +480,7 @@ void eventMgr_UpdatePhases(){
             break;
     }
 
+    matrix_commitView();
     oamUpdate(&oamMain);
 }
 
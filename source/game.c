@@ -41,6 +41,7 @@
 #include "objectMgr.h"
 #include "gfxInfo.h"
 #include "sprites.h"
+#include "matrixPool.h"
 
 int SWITCH = 1;
 
@@ -49,11 +50,12 @@ GameData gameData;
 PlayerData playerData;
 
 /**
- * @brief Actualiza en cada loop las diferentes funciones (por ahora, únicamente la encargada
- * de actualizar el estado de las teclas).
+ * @brief Actualiza en cada loop las diferentes funciones: el estado de las teclas y, aprovechando
+ * el tiempo ocioso del loop, el pool de matrices pre-generadas.
  */
 void game_Update(){
     input_UpdateKeyData();
+    matrixPool_refill();
 }
 /**
  * @brief Función auxiliar para obtener la siguiente fase.
@@ -185,6 +187,9 @@ void game_Loop()
                                 case INPUT_KEY_A:
                                     eventMgr_ScheduleEvent(EVENT_GAME_EVALUATE_BITBLOCK, NO_WAIT);
                                     break;
+                                case INPUT_KEY_R:
+                                    eventMgr_ScheduleEvent(EVENT_GAME_TOGGLE_HINT, NO_WAIT);
+                                    break;
                                 case INPUT_KEY_START:
                                     /*Libnds mantiene por más de un tick datos de teclas
                                      *Esto es para evitar los problemas que se generan por
@@ -256,12 +261,15 @@ void game_initData(){
     gameData.state = GAME_STATE_MAIN_MENU;
     gameData.phase = PHASE_WAITING_PLAYER_INPUT;
     gameData.mode = DIFFICULTY_NORMAL_MODE;
+    gameData.collapse = GAME_DEFAULT_COLLAPSE;
+    game_setBitBlockEvaluation(GAME_DEFAULT_RULE, GAME_DEFAULT_SHAPE);
     playerData.overflowScore = 0;
     playerData.totalOverflows = 0;
     playerData.runOverflows = 0;
     playerData.failScore = 0;
     gameData.matrixRegens = 0;
     gameData.destroyMatrixTime = TIMER_REGEN_NM;
+    gameData.hint = false;
 }
 
 /**
@@ -286,6 +294,53 @@ void game_setDifficulty(Difficulty difficulty){
     gameData.mode = difficulty;
 }
 
+/**
+ * @brief Establece a la vez la regla de overflow y la forma de la selección de la partida. Las
+ * tablas de todas las combinaciones están precalculadas, así que basta con cambiar la tabla en uso y
+ * rehacer una vez los mapas de overflow.
+ * Si cambia cualquiera de las dos, las matrices ya generadas en el pool se filtraron con las bandas
+ * de densidad de la combinación anterior, así que se descartan (@fn game_resetMatrixPool).
+ * Hoy solo se llama desde @fn game_initData, con @def GAME_DEFAULT_RULE y @def GAME_DEFAULT_SHAPE.
+ * @param rule regla, @enum OverflowRule.
+ * @param shape forma, @enum BitBlockShape.
+ */
+void game_setBitBlockEvaluation(OverflowRule rule, BitBlockShape shape){
+    bool changed = (rule != gameData.rule) || (shape != gameData.shape);
+
+    gameData.rule = rule;
+    gameData.shape = shape;
+    matrix_selectBitBlockEvaluation(gameData.rule, gameData.shape);
+    if(changed)
+        game_resetMatrixPool();
+}
+
+/**
+ * @brief Establece la regla de overflow de la partida, manteniendo la forma en uso
+ * (ver @fn game_setBitBlockEvaluation).
+ * @param rule regla, @enum OverflowRule.
+ */
+void game_setOverflowRule(OverflowRule rule){
+    game_setBitBlockEvaluation(rule, gameData.shape);
+}
+
+/**
+ * @brief Establece la forma de la selección alrededor del pivot, manteniendo la regla en uso
+ * (ver @fn game_setBitBlockEvaluation).
+ * @param shape forma, @enum BitBlockShape.
+ */
+void game_setBitBlockShape(BitBlockShape shape){
+    game_setBitBlockEvaluation(gameData.rule, shape);
+}
+
+/**
+ * @brief Descarta lo generado en el pool (@fn matrixPool_reset) y ajusta sus bandas de densidad a la
+ * regla y la forma en uso. Se vuelve a generar a partir de las mismas semillas, así que la partida
+ * sigue siendo reproducible; el loop principal lo repone en unas pocas vueltas.
+ */
+void game_resetMatrixPool(){
+    matrixPool_reset(matrixPool_getNextSeed(), matrixPool_getNextBitBlockSeed());
+}
+
 /**
  * @brief Establece si el sistema encargado de la gestión de
  * la destrucción/regeneración de la matriz está actualmente activo.
@@ -327,6 +382,7 @@ void game_manageGameOver(bool surrender){
 
     matrix_displayMatrix(false);
     objectMgr_despawnInatrix();
+    eventMgr_cancelAllEvents();
     eventMgr_ScheduleEvent(EVENT_SHOW_STATS, IN_4_SECONDS);
 
     if(!surrender)
@@ -0,0 +1,395 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file gameEvents.c
+ * @brief El "guión" del juego: qué ocurre cuando vence cada evento. Cada función se registra en
+ * el eventMgr para su evento (@fn gameEvents_registerHandlers), de manera que el eventMgr no
+ * necesita conocer ni la consola, ni los fondos, ni los objetos, ni la matriz.
+ */
+
+#include "gameEvents.h"
+#include "eventMgr.h"
+#include "backgrounds.h"
+#include "nds.h"
+#include "game.h"
+#include "matrix.h"
+#include "movementMgr.h"
+#include "objectMgr.h"
+#include "consoleUI.h"
+
+/**
+ * @brief Registra en el eventMgr la función de cada evento del juego. Los eventos sin función
+ * registrada simplemente se descartan al vencer.
+ */
+void gameEvents_registerHandlers(){
+    eventMgr_RegisterHandler(EVENT_MAIN_MENU_START, gameEvents_mainMenuStart);
+    eventMgr_RegisterHandler(EVENT_MAIN_MENU_HIDE_UI, gameEvents_mainMenuHideUI);
+    eventMgr_RegisterHandler(EVENT_MAIN_MENU_SHOW_UI, gameEvents_mainMenuShowUI);
+    eventMgr_RegisterHandler(EVENT_SHOW_CONTROLS, gameEvents_showControls);
+    eventMgr_RegisterHandler(EVENT_SHOW_GAMEPLAY, gameEvents_showGameplay);
+    eventMgr_RegisterHandler(EVENT_SHOW_LORE, gameEvents_showLore);
+    eventMgr_RegisterHandler(EVENT_SHOW_LORE_2, gameEvents_showLore2);
+
+    eventMgr_RegisterHandler(EVENT_INTRO_PRE_START, gameEvents_introPreStart);
+    eventMgr_RegisterHandler(EVENT_INTRO_START, gameEvents_introStart);
+    eventMgr_RegisterHandler(EVENT_INTRO_TEXT1, gameEvents_introText1);
+    eventMgr_RegisterHandler(EVENT_INTRO_TEXT2, gameEvents_introText2);
+    eventMgr_RegisterHandler(EVENT_INTRO_RABBIT2, gameEvents_introRabbit2);
+    eventMgr_RegisterHandler(EVENT_INTRO_TEXT3, gameEvents_introText3);
+    eventMgr_RegisterHandler(EVENT_INTRO_TEXT4, gameEvents_introText4);
+    eventMgr_RegisterHandler(EVENT_INTRO_SHOW_CAPSULES, gameEvents_introShowCapsules);
+    eventMgr_RegisterHandler(EVENT_INTRO_CAPSULE_SELECTED, gameEvents_introCapsuleSelected);
+    eventMgr_RegisterHandler(EVENT_INTRO_FINISH1, gameEvents_introFinish1);
+    eventMgr_RegisterHandler(EVENT_INTRO_FINISH2, gameEvents_introFinish2);
+    eventMgr_RegisterHandler(EVENT_INTRO_SETBG_MAIN, gameEvents_introSetBgMain);
+    eventMgr_RegisterHandler(EVENT_INTRO_SETBG_2, gameEvents_introSetBg2);
+    eventMgr_RegisterHandler(EVENT_INTRO_SETBG_3, gameEvents_introSetBg3);
+
+    eventMgr_RegisterHandler(EVENT_GAME_START, gameEvents_gameStart);
+    eventMgr_RegisterHandler(EVENT_GAME_START_DEST_MATRIX, gameEvents_gameStartDestMatrix);
+    eventMgr_RegisterHandler(EVENT_GAME_DESTROY_MATRIX_CHECK, gameEvents_gameDestroyMatrixCheck);
+    eventMgr_RegisterHandler(EVENT_GAME_DROP_BITBLOCK, gameEvents_gameDropBitBlock);
+    eventMgr_RegisterHandler(EVENT_GAME_REGENERATE_BITBLOCK, gameEvents_gameRegenerateBitBlock);
+    eventMgr_RegisterHandler(EVENT_GAME_HIDE_MATRIX, gameEvents_gameHideMatrix);
+    eventMgr_RegisterHandler(EVENT_GAME_REGENERATE_MATRIX, gameEvents_gameRegenerateMatrix);
+    eventMgr_RegisterHandler(EVENT_GAME_DESTROY_MATRIX, gameEvents_gameDestroyMatrix);
+    eventMgr_RegisterHandler(EVENT_GAME_INATRIX_MOVE_X, gameEvents_gameInatrixMoveX);
+    eventMgr_RegisterHandler(EVENT_GAME_INATRIX_MOVE_Y, gameEvents_gameInatrixMoveY);
+    eventMgr_RegisterHandler(EVENT_GAME_EVALUATE_BITBLOCK, gameEvents_gameEvaluateBitBlock);
+    eventMgr_RegisterHandler(EVENT_GAME_UI_SHOW_BASE, gameEvents_gameUIShowBase);
+    eventMgr_RegisterHandler(EVENT_GAME_TOGGLE_HINT, gameEvents_gameToggleHint);
+    eventMgr_RegisterHandler(EVENT_CLEAR_CONSOLE, gameEvents_clearConsole);
+    eventMgr_RegisterHandler(EVENT_SHOW_STATS, gameEvents_showStats);
+    eventMgr_RegisterHandler(EVENT_LISTEN_INPUT, gameEvents_listenInput);
+    eventMgr_RegisterHandler(EVENT_GAME_PAUSE, gameEvents_gamePause);
+}
+
+/*
+*********************
+*********************
+***** MAIN MENU *****
+*********************
+*********************
+*/
+
+/**
+ * @brief Muestra el menú principal y arranca el parpadeo del mensaje de inicio.
+ */
+void gameEvents_mainMenuStart(){
+    consoleUI_showMenu();
+    gameData.phase = PHASE_SHOW_MENU;
+    eventMgr_ScheduleEvent(EVENT_MAIN_MENU_HIDE_UI, IN_1_SECONDS);
+}
+
+/**
+ * @brief Parpadeo del menú: oculta el mensaje de inicio mientras se siga en el menú.
+ */
+void gameEvents_mainMenuHideUI(){
+    if(gameData.phase == PHASE_SHOW_MENU) {
+        iprintf("\x1b[9;00H |                           |");
+        eventMgr_ScheduleEvent(EVENT_MAIN_MENU_SHOW_UI, IN_1_SECONDS);
+    }
+}
+
+/**
+ * @brief Parpadeo del menú: vuelve a mostrar el mensaje de inicio.
+ */
+void gameEvents_mainMenuShowUI(){
+    if(gameData.phase == PHASE_SHOW_MENU) {
+        iprintf("\x1b[9;00H |  <PRESS START TO BEGIN>   |");
+        eventMgr_ScheduleEvent(EVENT_MAIN_MENU_HIDE_UI, IN_1_SECONDS);
+    }
+}
+
+void gameEvents_showControls(){
+    gameData.phase = PHASE_SHOW_CONTROLS;
+    consoleUI_showControls();
+}
+
+void gameEvents_showGameplay(){
+    gameData.phase = PHASE_SHOW_GAMEPLAY;
+    consoleUI_showGameplay();
+}
+
+void gameEvents_showLore(){
+    gameData.phase = PHASE_SHOW_LORE;
+    consoleUI_showLore();
+}
+
+void gameEvents_showLore2(){
+    gameData.phase = PHASE_SHOW_LORE_2;
+    consoleUI_showLore2();
+}
+
+/*
+*********************
+*********************
+******* INTRO *******
+*********************
+*********************
+*/
+
+void gameEvents_introPreStart(){
+    background_setBackground(BG_MATRIX);
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, NO_WAIT);
+    eventMgr_ScheduleEvent(EVENT_INTRO_START, IN_4_SECONDS);
+}
+
+void gameEvents_introStart(){
+    iprintf("\x1b[09;10H _");
+    iprintf("\x1b[10;00H Wake up, Inatrix...");
+    background_setBackground(BG_MATRIX_INATRIX);
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT1, IN_4_SECONDS);
+}
+
+void gameEvents_introText1(){
+    iprintf("\x1b[10;00H The Matrix has you...");
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT2, IN_5_SECONDS);
+}
+
+void gameEvents_introText2(){
+    iprintf("\x1b[10;00H Follow the white rabbit.");
+    background_setBackground(BG_RABBIT);
+    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT3, IN_5_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_INTRO_RABBIT2, IN_3_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
+}
+
+void gameEvents_introRabbit2(){
+    background_setBackground(BG_RABBIT2);
+}
+
+void gameEvents_introText3(){
+    iprintf("\x1b[09;15H _");
+    iprintf("\x1b[10;00H Knock, knock, Inatrix.");
+    background_setBackground(BG_RABBIT3);
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_INTRO_TEXT4, IN_4_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_INTRO_SETBG_3, IN_3_SECONDS);
+}
+
+void gameEvents_introText4(){
+    iprintf("\x1b[10;00H So, blue pill or red pill?");
+    iprintf("\x1b[20;00H Blue - Normal");
+    iprintf("\x1b[20;18H Red - Hard");
+    eventMgr_ScheduleEvent(EVENT_INTRO_SHOW_CAPSULES, IN_2_SECONDS);
+}
+
+void gameEvents_introShowCapsules(){
+    objectMgr_spawnCapsules();
+    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
+}
+
+void gameEvents_introCapsuleSelected(){
+    char ht1[] = "\x1b[10;00H I see... good choice.";
+    char nt1[] = "\x1b[10;00H You are weak.";
+
+    iprintf("\x1b[2J");
+    iprintf(gameData.mode == DIFFICULTY_HARD_MODE ? ht1 : nt1);
+    objectMgr_manageSelectedCapsule(gameData.mode);
+    gameData.phase = PHASE_MOVE_CAPSULE;
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_2_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_INTRO_FINISH1, IN_4_SECONDS); // Ojo, algo más introductorio rollo into the matrix.
+}
+
+void gameEvents_introFinish1(){
+    char ht2[] = "\x1b[10;00H or not? hahaha...";
+    char nt2[] = "\x1b[10;00H You will be lost in the Matrix";
+
+    iprintf(gameData.mode == DIFFICULTY_HARD_MODE ? ht2 : nt2);
+    objectMgr_manageSelectedCapsule(gameData.mode == DIFFICULTY_NORMAL_MODE ? GFX_CAPSULE_RED : GFX_CAPSULE_BLUE);
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_INTRO_FINISH2, IN_4_SECONDS);
+}
+
+void gameEvents_introFinish2(){
+    consoleUI_showIntro1();
+    objectMgr_spawnInatrix();
+    eventMgr_ScheduleEvent(EVENT_GAME_START, IN_4_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_CLEAR_CONSOLE, IN_3_SECONDS);
+}
+
+void gameEvents_introSetBgMain(){
+    background_setBackground(BG_MAIN);
+}
+
+void gameEvents_introSetBg2(){
+    background_setBackground(BG_MATRIX);
+}
+
+void gameEvents_introSetBg3(){
+    background_setBackground(BG_MATRIX2);
+}
+
+/*
+*********************
+*********************
+******* GAME ********
+*********************
+*********************
+*/
+
+void gameEvents_gameStart(){
+    gameData.state = GAME_STATE_GAME;
+    matrix_displayMatrix(true);
+    consoleUI_showIntro2();
+    eventMgr_ScheduleEvent(EVENT_GAME_START_DEST_MATRIX, IN_4_SECONDS);
+    eventMgr_ScheduleEvent(EVENT_GAME_UI_SHOW_BASE, IN_4_SECONDS);
+}
+
+void gameEvents_gameStartDestMatrix(){
+    game_enableDestroyMatrix();
+    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
+    eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
+}
+
+/**
+ * @brief Cuenta atrás de la destrucción de la matriz, una vez por segundo. Al llegar a 0 se
+ * destruye la matriz si el jugador ha conseguido algún overflow y, si no, termina la partida.
+ */
+void gameEvents_gameDestroyMatrixCheck(){
+    if(gameData.destroyMatrixActive){
+        gameData.destroyMatrixTime -= 1;
+        consoleUI_showUI();
+        if(gameData.destroyMatrixTime <= 0){
+            if(game_achievedMinimumOverflows()){
+                game_setDestroyMatrix(false);
+                eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX, NO_WAIT);
+            }
+            else
+            {
+                game_manageGameOver(false);
+                return;
+            }
+        }
+        eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
+    }
+}
+
+void gameEvents_gameDropBitBlock(){
+    gameData.phase = PHASE_BITBLOCK_FALLING;
+}
+
+/**
+ * @brief Rellena el hueco del bitblock evaluado: con gravedad se derrumban las columnas (ver
+ * @fn matrix_collapseBitBlock) y si no se regenera en su sitio.
+ */
+void gameEvents_gameRegenerateBitBlock(){
+    if(gameData.collapse == COLLAPSE_GRAVITY){
+        matrix_collapseBitBlock();
+        gameData.phase = PHASE_BITBLOCK_COLLAPSING;
+        return;
+    }
+    matrix_regenerateBitBlock();
+    game_setDestroyMatrix(true);
+    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
+    eventMgr_ScheduleEvent(EVENT_GAME_DESTROY_MATRIX_CHECK, IN_1_SECONDS);
+}
+
+void gameEvents_gameHideMatrix(){
+    gameData.phase = PHASE_REGENERATING_MATRIX;
+    matrix_displayMatrix(false);
+    eventMgr_ScheduleEvent(EVENT_GAME_REGENERATE_MATRIX, IN_5_SECONDS);
+}
+
+void gameEvents_gameRegenerateMatrix(){
+    matrix_regenerateMatrix();
+    gameData.phase = PHASE_REVEALING_MATRIX;
+}
+
+void gameEvents_gameDestroyMatrix(){
+    consoleUI_showRegeneratingMatrix();
+    gameData.phase = PHASE_DESTROYING_MATRIX;
+}
+
+void gameEvents_gameInatrixMoveX(){
+    movementMgr_movePosition(MOVEMENT_INATRIX_X);
+    objectMgr_setAnimationActive(ANIMATION_BIT_SHAKE, false);
+    gameData.phase = PHASE_MOVE_INATRIX_X;
+}
+
+void gameEvents_gameInatrixMoveY(){
+    movementMgr_movePosition(MOVEMENT_INATRIX_Y);
+    objectMgr_setAnimationActive(ANIMATION_BIT_SHAKE, false);
+    gameData.phase = PHASE_MOVE_INATRIX_Y;
+}
+
+/**
+ * @brief Evalúa el bitblock seleccionado, muestra el resultado y programa su caída.
+ */
+void gameEvents_gameEvaluateBitBlock(){
+    bool ovf;
+
+    objectMgr_setAnimationActive(ANIMATION_BIT_SHAKE, false);
+    ovf = matrix_evalBitBlockOverflow();
+    if(!game_manageScore(ovf))
+        return;
+    if(ovf){
+        game_setDestroyMatrix(false);
+        consoleUI_showOverflow();
+        eventMgr_ScheduleEvent(EVENT_GAME_UI_SHOW_BASE, IN_4_SECONDS);
+    }else{
+        game_setDestroyMatrix(false);
+        consoleUI_showFail();
+        eventMgr_ScheduleEvent(EVENT_GAME_UI_SHOW_BASE, IN_5_SECONDS);
+    }
+    eventMgr_ScheduleEvent(EVENT_GAME_DROP_BITBLOCK, IN_1_SECONDS + IN_500_MS);
+}
+
+void gameEvents_gameUIShowBase(){
+    game_setDestroyMatrix(true);
+    consoleUI_showUI();
+}
+
+/**
+ * @brief Muestra u oculta la pista (ver @fn consoleUI_showHint). Si en pantalla está el UI base se
+ * repinta ya; si hay un mensaje de overflow o fallo, la pista aparecerá al volver al UI base.
+ * La entrada se vuelve a escuchar un poco después, para que la tecla mantenida no la alterne más veces.
+ */
+void gameEvents_gameToggleHint(){
+    gameData.hint = !gameData.hint;
+    if(gameData.destroyMatrixActive)
+        consoleUI_showUI();
+    eventMgr_ScheduleEvent(EVENT_LISTEN_INPUT, IN_500_MS);
+}
+
+void gameEvents_clearConsole(){
+    iprintf("\x1b[2J");
+}
+
+void gameEvents_showStats(){
+    consoleUI_showStats();
+    gameData.state = GAME_STATE_STATS;
+    gameData.phase = PHASE_SHOW_STATS;
+}
+
+void gameEvents_listenInput(){
+    gameData.phase = PHASE_WAITING_PLAYER_INPUT;
+}
+
+void gameEvents_gamePause(){
+    gameData.state = GAME_STATE_PAUSE;
+    gameData.phase = PHASE_GAME_PAUSE;
+    consoleUI_showPauseUI();
+}
@@ -371,62 +371,51 @@ void gfxInfo_init(){
     gfxInfo_setGfx(GFX_INATRIX_X, SpriteSize_16x16);
     gfxInfo_setGfx(GFX_INATRIX_Y, SpriteSize_16x16);
 
+    /* DIGITS - Compartidos por todas las celdas de las matrices */
+    gfxInfo_setGfx(GFX_DIGIT_ONE, SpriteSize_16x16);
+    gfxInfo_setGfx(GFX_DIGIT_ZERO, SpriteSize_16x16);
+
     /* INATRIX SPELLS */
     gfxInfo_setGfx(GFX_INATRIX_SPELL_X, SpriteSize_16x16);
 
 }
 
 /**
- *  @brief Función que genera la Matrix de manera independiente
- * Para poder construir los sprites asociados a cada elemento de la matriz.
- * Se encarga de reservar memoria en el banco de memoria de la NDS y, una vez
- * obtenido el puntero al sprite, se vincula a su posición correspondiente en la
- * matriz.
- * @param base: Dirección de memomria del primer elemento de la matriz bidimensional.
- * @param size: Número de filas/columnas (matriz cuadrada).
+ *  @brief Función que genera la vista gráfica de una matriz, reservando un sprite por celda.
+ * Los bits ya no viven en los sprites (ver bitboards en matrix.c), por lo que aquí no se
+ * escribe ningún bitmap: todas las celdas comparten los GFX de los dígitos, y cada una
+ * apuntará al que corresponda en el momento de pintarse. Tampoco hace falta un @struct Sprite
+ * por celda: la vista guarda únicamente el índice OAM de cada una.
+ * @param view: Dirección de memoria del primer elemento de la vista bidimensional.
+ * @param rows: Número de filas.
+ * @param cols: Número de columnas.
  *
- * @nota: *(base + i*size + j) En memoria dinámica, C trata los arrays bidimensionales
- * como si fueran un vector, con lo que para acceder a cada elemento lo hago mediante la
- * desreferencia de la posición dada por: dirección base + número de fila*número de elementos en esa fila
- * + número de columna. De ésta manera puedo comprobar el id del GFX en esa posición.
+ * @nota: *(view + i*cols + j) C trata los arrays bidimensionales como si fueran un vector,
+ * con lo que para acceder a cada elemento lo hago mediante la desreferencia de la posición dada por:
+ * dirección base + número de fila*número de elementos en esa fila + número de columna.
  */
-void gfxInfo_initMatrix(Binary *base, uint8 size){
-    for(int i = 0; i < size; i++){
-        for(int j = 0; j < size; j++){
-            gfxInfo_allocateMatrixElement(*(base + i*size + j) ? GFX_DIGIT_ONE : GFX_DIGIT_ZERO);
-            gfxInfo_linkToMatrix(size, i, j, *(base + i*size + j) ? BIT_ONE : BIT_ZERO);
-        }
-    }
+void gfxInfo_initMatrix(uint8* view, uint8 rows, uint8 cols){
+    for(int i = 0; i < rows; i++)
+        for(int j = 0; j < cols; j++)
+            *(view + i*cols + j) = gfxInfo_allocateMatrixElement();
 }
 
 /**
- * @brief Reserva memoria para un elemento de la matrix.
+ * @brief Reserva un sprite (índice OAM) para una celda de la matriz. No reserva memoria:
+ * el GFX del dígito se indica cada vez que se pinta (ver @fn sprites_setSpriteGfx).
+ * @return Índice OAM reservado.
  */
-void gfxInfo_allocateMatrixElement(GfxID gfxId){
-    gfxInfo_setGfx(gfxId, SpriteSize_16x16);
-    sprites_memorySetup(gfxList[gfxGUID - 1]);
+uint8 gfxInfo_allocateMatrixElement(){
+    return gfxGUID++;
 }
 
 /**
- * @brief Crear en memoria dinámica un @struct MatrixElement y lo asigna
- * a la posicón indicada del Bitblock/Matriz
- * @param size: Tamaño de la matriz
- * @param i: fila
- * @param j: columna
- * @param bit: indica el valor del dígito binario del tipo @typedef Binary
- * @todo: Mejorar esta chapuza.
+ * @brief Obtiene el GFX compartido correspondiente a un dígito binario.
+ * @param bit valor del dígito binario del tipo @typedef Binary
+ * @return Puntero al @struct GfxData del dígito.
  */
-void gfxInfo_linkToMatrix(uint8 size, uint8 i, uint8 j, Binary bit) {
-    if(size == BITBLOCK_SIZE){
-        bitBlockBuffer[i][j] = malloc(sizeof(MatrixElement));
-        bitBlockBuffer[i][j]->sprite = sprites[gfxGUID - 1];
-        bitBlockBuffer[i][j]->bit = bit;
-    }else
-    {
-        matrix[i][j] = malloc(sizeof(MatrixElement));
-        matrix[i][j]->sprite = sprites[gfxGUID - 1];
-        matrix[i][j]->bit = bit;
-    }
+GfxData* gfxInfo_getDigitGfx(Binary bit){
+    return gfxList[bit ? GFX_DIGIT_ONE : GFX_DIGIT_ZERO];
 }
 
 /**
@@ -7,6 +7,7 @@ y en otro ejemplo de Jaeden Ameronen
 #include <stdio.h>		//librería de entrada/salida estandar de C
 #include <stdlib.h>		//librería estandar de C para reserva de memoria y conversiones númericas
 #include <unistd.h>		//librería para asegurar la compatibilidad entre sistemas operativos
+#include <time.h>		//librería de tiempo, para la semilla de la sesión
 
 //librerías desarroladas por nosotros para el proyecto
 
@@ -16,16 +17,22 @@ y en otro ejemplo de Jaeden Ameronen
 #include "input.h"
 #include "controllers.h"
 #include "eventMgr.h"
+#include "gameEvents.h"
 #include "audioMgr.h"
 #include "movementMgr.h"
 #include "objectMgr.h"
+#include "rng.h"
+#include "matrixPool.h"
 
 int main(void) {
+    rng_initSystem(time(0)); // Semilla única por sesión; fijarla permite reproducir la partida.
     eventMgr_InitEventSystem();
+    gameEvents_registerHandlers();
     controllers_InitSetup();
     inicializarGraficosSprites();
     //audioMgr_initAudio();
-    matrix_initSystem();
+    matrix_initSystem(MATRIX_DEFAULT_SIZE);
+    matrixPool_init();
     movementMgr_initSystem();
     objectMgr_init();
     game_Loop();
@@ -28,29 +28,88 @@
 #include "gfxInfo.h"
 #include "eventMgr.h"
 #include "game.h"
-#include <math.h>
-#include <time.h>
+#include "sprites.h"
+#include "rng.h"
+#include "matrixPool.h"
 
 /**
- * @var matrix[MATRIX_SIZE][MATRIX_SIZE]: Matriz principal, array bidimensional 10x10
- * que contiene punteros a structs del tipo @struct MatrixElement.
- * @var bitBlockBuffer[BITBLOCK_SIZE][BITBLOCK_SIZE] Matriz que hace de buffer para servir de ayuda
+ * @var matrix[MATRIX_MAX_SIZE]: Matriz principal en forma de bitboard, una fila empaquetada
+ * por cada @typedef BitboardRow. Es el estado lógico real de la matriz; solo se usan las
+ * primeras @var matrixSize filas.
+ * @var bitBlockBuffer[BITBLOCK_ROWS]: Bitboard que hace de buffer para servir de ayuda
  * cuando el jugador elimina un bloque de bits.
+ * @var matrixSprites[MATRIX_VIEW_SIZE][MATRIX_VIEW_SIZE]: Vista gráfica del viewport, el índice OAM
+ * del sprite fijo de cada celda de pantalla. El dígito que muestra cada sprite se decide al pintarlo,
+ * en función del bit de la celda de la matriz que cae bajo él.
+ * @var matrixDigits[MATRIX_VIEW_SIZE][MATRIX_VIEW_SIZE]: Dígito que muestra ahora mismo cada sprite
+ * del viewport (ver @fn matrix_syncCell).
+ * @var bitBlockSprites[BITBLOCK_ROWS][BITBLOCK_COLS]: Vista gráfica del bitBlockBuffer (índices OAM).
  * @var pivot: elemento que hará de centro del bloque de bits.
+ * @var viewport: celda de la matriz en la esquina superior izquierda de la pantalla.
+ * @var matrixSize: número de filas/columnas de la matriz en esta sesión.
  */
-MatrixElement* matrix[MATRIX_SIZE][MATRIX_SIZE];
-MatrixElement* bitBlockBuffer[BITBLOCK_SIZE][BITBLOCK_SIZE];
+BitboardRow matrix[MATRIX_MAX_SIZE];
+BitboardRow bitBlockBuffer[BITBLOCK_ROWS];
+uint8 matrixSprites[MATRIX_VIEW_SIZE][MATRIX_VIEW_SIZE];
+Binary matrixDigits[MATRIX_VIEW_SIZE][MATRIX_VIEW_SIZE];
+uint8 bitBlockSprites[BITBLOCK_ROWS][BITBLOCK_COLS];
 MatrixPivot* pivot; // Quizá hacer un pivotLocked para entre eventos, evitar updates.
+MatrixViewport viewport;
+uint8 matrixSize = MATRIX_DEFAULT_SIZE;
+
+/**
+ * @var overflowMaps[OVERFLOW_MAPS]: Mapas de overflow persistentes, uno por dificultad
+ * (indexados por @enum Difficulty). Se mantienen al día con cada mutación de la matriz.
+ */
+OverflowMap overflowMaps[OVERFLOW_MAPS];
+
+/**
+ * @var rowWindows[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE]: Caché de ventanas de fila: rowWindows[i][j] es el
+ * valor de los @def BITBLOCK_COLS bits de la fila i que cubre un bloque con pivot en la columna j
+ * (solo columnas de pivot). Los bloques de pivots vecinos se solapan casi por completo, así que cada
+ * ventana se extrae una única vez, cuando cambia su fila (ver @fn matrix_refreshRowWindows).
+ */
+uint8 rowWindows[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE];
+
+/**
+ * @var viewDirty[MATRIX_VIEW_SIZE]: Celdas del viewport cuyo estado (dígito, posición o visibilidad)
+ * puede haber cambiado desde el último frame pintado, ver @fn matrix_commitView.
+ * @var matrixGeneration: Se incrementa con cada cambio de la matriz o de su vista; permite saber si
+ * algo ha cambiado sin recorrer nada.
+ * @var committedGeneration: Generación ya pintada en pantalla.
+ */
+ViewMask viewDirty[MATRIX_VIEW_SIZE];
+uint32 matrixGeneration = 0;
+uint32 committedGeneration = 0;
+
+/**
+ * @var collapseOffset[MATRIX_VIEW_SIZE]: Píxeles que le faltan por caer a cada columna del viewport
+ * durante el colapso por gravedad (0 si no está cayendo). Se aplican al pintar las celdas de la
+ * columna hasta la fila @var collapseLastRows de la matriz.
+ * @var collapseColumns: Columnas del viewport que están cayendo.
+ * @var collapseLastRows[MATRIX_VIEW_SIZE]: Última fila de la matriz que cae en cada columna del
+ * viewport (la inferior de su hueco, que depende de la forma).
+ */
+uint8 collapseOffset[MATRIX_VIEW_SIZE];
+ViewMask collapseColumns;
+uint8 collapseLastRows[MATRIX_VIEW_SIZE];
+
+/**
+ * @var revealRow: Filas del viewport ya mostradas tras regenerar la matriz; las demás se pintan
+ * ocultas (ver @fn matrix_revealMatrixEffect). Fuera de la regeneración vale @def MATRIX_VIEW_SIZE.
+ * @var revealWindowsRow: Primera fila de la matriz cuyas ventanas (@var rowWindows) faltan por refrescar.
+ */
+uint8 revealRow = MATRIX_VIEW_SIZE;
+uint8 revealWindowsRow;
 bool isMatrixHidden = true;
 bool isBufferHidden = true;
 
 /**
- * @var baseMatrix[MATRIX_SIZE][MATRIX_SIZE]: Hace matriz base. Realmente la matriz que se gestionará
- * en el juego es una matriz que contiene direcciones de memoria de structs @struct MatrixElement.
- * Ésta únicamente hace de plantilla para que el sistema de creación y reserva de sprites en
- * memoria, sepa qué GFX generar y asociar a cada posición, de manera inicial.
+ * @var baseMatrix[MATRIX_BASE_SIZE][MATRIX_BASE_SIZE]: Hace matriz base. Realmente la matriz que se
+ * gestionará en el juego es el bitboard @var matrix. Ésta únicamente hace de plantilla para cargar
+ * el estado inicial del mismo; en matrices más grandes se repite en mosaico.
  */
-Binary baseMatrix[MATRIX_SIZE][MATRIX_SIZE] = {
+Binary baseMatrix[MATRIX_BASE_SIZE][MATRIX_BASE_SIZE] = {
 
         { 0, 0, 1, 0, 0, 1, 0, 0, 1, 1 },
         { 1, 0, 1, 1, 1, 0, 1, 0, 1, 0 },
@@ -67,9 +126,9 @@ Binary baseMatrix[MATRIX_SIZE][MATRIX_SIZE] = {
 
 /**
  * @var baseBitBlockBuffer: Mismo caso que la baseMatrix, pero únicamente en lo relativo
- * a los bloques de bits.
+ * a los bloques de bits (también se repite en mosaico si el bloque no es de 3x3).
  */
-Binary baseBitBlockBuffer[BITBLOCK_SIZE][BITBLOCK_SIZE] = {
+Binary baseBitBlockBuffer[BITBLOCK_BASE_SIZE][BITBLOCK_BASE_SIZE] = {
 
         { 1, 0, 1 },
         { 0, 1, 0 },
@@ -77,14 +136,151 @@ Binary baseBitBlockBuffer[BITBLOCK_SIZE][BITBLOCK_SIZE] = {
 
 };
 
+#if BITBLOCK_LOOKUP_TABLE
+/**
+ * @var bitBlockRuleTables[OVERFLOW_RULES][BITBLOCK_SHAPES][BITBLOCK_PATTERNS]: Tablas de evaluación de
+ * bloques de bits, una por cada regla de overflow (@enum OverflowRule) y forma de selección
+ * (@enum BitBlockShape), generadas en tiempo de compilación para la geometría del bloque. La forma ya
+ * va aplicada en cada entrada, así que evaluar cualquier forma sigue siendo un único acceso.
+ * Ver @def BITBLOCK_ENTRY y siguientes.
+ * @var bitBlockTable: Tabla de la regla y la forma en uso, ver @fn matrix_selectBitBlockEvaluation.
+ */
+#define BITBLOCK_TABLE_1(e, m, p) e(p, m)
+#define BITBLOCK_TABLE_2(e, m, p) BITBLOCK_TABLE_1(e, m, p), BITBLOCK_TABLE_1(e, m, (p) + 1)
+#define BITBLOCK_TABLE_4(e, m, p) BITBLOCK_TABLE_2(e, m, p), BITBLOCK_TABLE_2(e, m, (p) + 2)
+#define BITBLOCK_TABLE_8(e, m, p) BITBLOCK_TABLE_4(e, m, p), BITBLOCK_TABLE_4(e, m, (p) + 4)
+#define BITBLOCK_TABLE_16(e, m, p) BITBLOCK_TABLE_8(e, m, p), BITBLOCK_TABLE_8(e, m, (p) + 8)
+#define BITBLOCK_TABLE_32(e, m, p) BITBLOCK_TABLE_16(e, m, p), BITBLOCK_TABLE_16(e, m, (p) + 16)
+#define BITBLOCK_TABLE_64(e, m, p) BITBLOCK_TABLE_32(e, m, p), BITBLOCK_TABLE_32(e, m, (p) + 32)
+#define BITBLOCK_TABLE_128(e, m, p) BITBLOCK_TABLE_64(e, m, p), BITBLOCK_TABLE_64(e, m, (p) + 64)
+#define BITBLOCK_TABLE_256(e, m, p) BITBLOCK_TABLE_128(e, m, p), BITBLOCK_TABLE_128(e, m, (p) + 128)
+#define BITBLOCK_TABLE_512(e, m, p) BITBLOCK_TABLE_256(e, m, p), BITBLOCK_TABLE_256(e, m, (p) + 256)
+#define BITBLOCK_TABLE_1024(e, m, p) BITBLOCK_TABLE_512(e, m, p), BITBLOCK_TABLE_512(e, m, (p) + 512)
+
+#if BITBLOCK_CELLS == 1
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_2(e, m, 0)
+#elif BITBLOCK_CELLS == 2
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_4(e, m, 0)
+#elif BITBLOCK_CELLS == 3
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_8(e, m, 0)
+#elif BITBLOCK_CELLS == 4
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_16(e, m, 0)
+#elif BITBLOCK_CELLS == 5
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_32(e, m, 0)
+#elif BITBLOCK_CELLS == 6
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_64(e, m, 0)
+#elif BITBLOCK_CELLS == 7
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_128(e, m, 0)
+#elif BITBLOCK_CELLS == 8
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_256(e, m, 0)
+#elif BITBLOCK_CELLS == 9
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_512(e, m, 0)
+#else
+#define BITBLOCK_TABLE(e, m) BITBLOCK_TABLE_1024(e, m, 0)
+#endif
+
+#define BITBLOCK_SHAPE_TABLES(e) { \
+        [BITBLOCK_SHAPE_SQUARE] = { BITBLOCK_TABLE(e, BITBLOCK_SHAPE_MASK_SQUARE) }, \
+        [BITBLOCK_SHAPE_PLUS] = { BITBLOCK_TABLE(e, BITBLOCK_SHAPE_MASK_PLUS) }, \
+        [BITBLOCK_SHAPE_L] = { BITBLOCK_TABLE(e, BITBLOCK_SHAPE_MASK_L) }, \
+        [BITBLOCK_SHAPE_LINE] = { BITBLOCK_TABLE(e, BITBLOCK_SHAPE_MASK_LINE) }, \
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = { BITBLOCK_TABLE(e, BITBLOCK_SHAPE_MASK_SMALL_SQUARE) } }
+
+const uint8 bitBlockRuleTables[OVERFLOW_RULES][BITBLOCK_SHAPES][BITBLOCK_PATTERNS] = {
+        [OVERFLOW_RULE_ROWS] = BITBLOCK_SHAPE_TABLES(BITBLOCK_ENTRY),
+        [OVERFLOW_RULE_COLUMNS] = BITBLOCK_SHAPE_TABLES(BITBLOCK_COLUMNS_ENTRY),
+        [OVERFLOW_RULE_DIAGONALS] = BITBLOCK_SHAPE_TABLES(BITBLOCK_DIAGONALS_ENTRY),
+        [OVERFLOW_RULE_SIGNED_ROWS] = BITBLOCK_SHAPE_TABLES(BITBLOCK_SIGNED_ENTRY),
+        [OVERFLOW_RULE_ANY_ROW] = BITBLOCK_SHAPE_TABLES(BITBLOCK_ANY_ROW_ENTRY)
+};
+
+const uint8* bitBlockTable = bitBlockRuleTables[OVERFLOW_RULE_ROWS][BITBLOCK_SHAPE_SQUARE];
+#endif
+
+/**
+ * @var bitBlockShapeMasks[BITBLOCK_SHAPES]: Máscara de cada forma de selección sobre el patrón del
+ * bloque, ver @def BITBLOCK_SHAPE_MASK_SQUARE y siguientes.
+ */
+const uint16 bitBlockShapeMasks[BITBLOCK_SHAPES] = {
+        [BITBLOCK_SHAPE_SQUARE] = BITBLOCK_SHAPE_MASK_SQUARE,
+        [BITBLOCK_SHAPE_PLUS] = BITBLOCK_SHAPE_MASK_PLUS,
+        [BITBLOCK_SHAPE_L] = BITBLOCK_SHAPE_MASK_L,
+        [BITBLOCK_SHAPE_LINE] = BITBLOCK_SHAPE_MASK_LINE,
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = BITBLOCK_SHAPE_MASK_SMALL_SQUARE
+};
+
 /**
- * @brief Función inicializadora del sistema de matrices. Reserva memoria, escribe bitmaps en el banco
- * de memoria de la NDS (main) en función de las matrices base.
+ * @var overflowRuleLimits[OVERFLOW_RULES][BITBLOCK_SHAPES][OVERFLOW_MAPS]: Límites de cada regla,
+ * forma y dificultad, en la escala de la propia regla (solo informativo: los veredictos ya están en
+ * las tablas). En @enum OVERFLOW_RULE_ANY_ROW, el límite de una fila completa.
  */
-void matrix_initSystem(){
-    gfxInfo_initMatrix(baseMatrix[0], MATRIX_SIZE);
-    gfxInfo_initMatrix(baseBitBlockBuffer[0], BITBLOCK_SIZE);
+#define BITBLOCK_LIMITS(max) { ((max) * 3) / 7, ((max) * 5) / 7 }
+#define BITBLOCK_ROW_MAX_OF(mask) BITBLOCK_MASK
+#define BITBLOCK_SHAPE_LIMITS(maxOf) { \
+        [BITBLOCK_SHAPE_SQUARE] = BITBLOCK_LIMITS(maxOf(BITBLOCK_SHAPE_MASK_SQUARE)), \
+        [BITBLOCK_SHAPE_PLUS] = BITBLOCK_LIMITS(maxOf(BITBLOCK_SHAPE_MASK_PLUS)), \
+        [BITBLOCK_SHAPE_L] = BITBLOCK_LIMITS(maxOf(BITBLOCK_SHAPE_MASK_L)), \
+        [BITBLOCK_SHAPE_LINE] = BITBLOCK_LIMITS(maxOf(BITBLOCK_SHAPE_MASK_LINE)), \
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = BITBLOCK_LIMITS(maxOf(BITBLOCK_SHAPE_MASK_SMALL_SQUARE)) }
+
+const uint8 overflowRuleLimits[OVERFLOW_RULES][BITBLOCK_SHAPES][OVERFLOW_MAPS] = {
+        [OVERFLOW_RULE_ROWS] = BITBLOCK_SHAPE_LIMITS(BITBLOCK_VALUE),
+        [OVERFLOW_RULE_COLUMNS] = BITBLOCK_SHAPE_LIMITS(BITBLOCK_COLUMNS_VALUE),
+        [OVERFLOW_RULE_DIAGONALS] = BITBLOCK_SHAPE_LIMITS(BITBLOCK_DIAGONALS_VALUE),
+        [OVERFLOW_RULE_SIGNED_ROWS] = BITBLOCK_SHAPE_LIMITS(BITBLOCK_SIGNED_MAX_OF),
+        [OVERFLOW_RULE_ANY_ROW] = BITBLOCK_SHAPE_LIMITS(BITBLOCK_ROW_MAX_OF)
+};
+
+/**
+ * Forma de selección en uso, desglosada para recorrerla sin tocar celdas fuera de ella (ver
+ * @fn matrix_loadBitBlockShape):
+ * @var shapeRowMasks[BITBLOCK_ROWS]: celdas de cada fila del bloque, columna 0 en el bit más
+ * significativo (como las filas de los bitboards).
+ * @var shapeViewMasks[BITBLOCK_ROWS]: las mismas celdas con la columna c en el bit c (como @typedef ViewMask).
+ * @var shapeCells: número total de celdas de la forma.
+ * @var shapeFallMasks[BITBLOCK_COLS]: columnas de cada grupo de caída (mismas filas en la forma), en
+ * el orden de @var shapeRowMasks; @var shapeFallViewMasks, en el de @var shapeViewMasks.
+ * @var shapeFallTop[BITBLOCK_COLS]: primera fila de la forma en las columnas del grupo.
+ * @var shapeFallHeight[BITBLOCK_COLS]: celdas de la forma en cada columna del grupo (han de ser contiguas).
+ * @var shapeFalls: número de grupos.
+ */
+uint16 shapeRowMasks[BITBLOCK_ROWS];
+ViewMask shapeViewMasks[BITBLOCK_ROWS];
+uint8 shapeCells;
+uint16 shapeFallMasks[BITBLOCK_COLS];
+ViewMask shapeFallViewMasks[BITBLOCK_COLS];
+uint8 shapeFallTop[BITBLOCK_COLS];
+uint8 shapeFallHeight[BITBLOCK_COLS];
+uint8 shapeFalls;
+
+/**
+ * @brief Función inicializadora del sistema de matrices. Fija el tamaño de la matriz para la
+ * sesión, carga los bitboards a partir de las matrices base y reserva un sprite por celda
+ * del viewport (no de la matriz) para su vista gráfica.
+ * @param size Número de filas/columnas, acotado a [@def MATRIX_MIN_SIZE, @def MATRIX_MAX_SIZE].
+ */
+void matrix_initSystem(uint8 size){
+    if(size < MATRIX_MIN_SIZE)
+        size = MATRIX_MIN_SIZE;
+    else if(size > MATRIX_MAX_SIZE)
+        size = MATRIX_MAX_SIZE;
+
+    matrixSize = size;
+    viewport.i = viewport.j = 0;
+    matrix_loadTiledBitboard(baseMatrix[0], MATRIX_BASE_SIZE, matrix, matrixSize, matrixSize);
+    matrix_loadTiledBitboard(baseBitBlockBuffer[0], BITBLOCK_BASE_SIZE, bitBlockBuffer, BITBLOCK_ROWS, BITBLOCK_COLS);
+    gfxInfo_initMatrix(matrixSprites[0], MATRIX_VIEW_SIZE, MATRIX_VIEW_SIZE);
+    gfxInfo_initMatrix(bitBlockSprites[0], BITBLOCK_ROWS, BITBLOCK_COLS);
+    for(int i = 0; i < MATRIX_VIEW_SIZE; i++){
+        for(int j = 0; j < MATRIX_VIEW_SIZE; j++){
+            matrixDigits[i][j] = matrix_getBit(i, j);
+            matrix_displayCell(matrixSprites[i][j], matrixDigits[i][j], i, j, true);
+        }
+    }
     pivot = malloc(sizeof(MatrixPivot));
+    matrix_loadBitBlockShape(gameData.shape);
+    matrix_refreshRowWindows(0, matrixSize);
+    matrix_rebuildOverflowMaps();
 }
 
 /**
@@ -104,7 +300,8 @@ void matrix_displayBitBlockBuffer(bool display){
 }
 
 /**
- * @brief Función auxiliar para mostrar/ocultar matrices.
+ * @brief Función auxiliar para mostrar/ocultar matrices. Marca todo el viewport como pendiente:
+ * en el siguiente frame se vuelven a pintar (y a colocar en su sitio) las celdas que lo necesiten.
  * @param hide
  */
 void matrix_hideMatrix(bool hide){
@@ -114,16 +311,12 @@ void matrix_hideMatrix(bool hide){
     else
         isMatrixHidden = false;
 
-    for(int i = 0; i < MATRIX_SIZE; i++)
-        for (int j = 0; j < MATRIX_SIZE; j++)
-            sprites_displaySprite(matrix[i][j]->sprite->index,
-                                  MATRIX_X_POS + (j * MATRIX_X_PADDING),
-                                  MATRIX_Y_POS + (i * MATRIX_Y_PADDING),
-                                  hide);
+    matrix_markRowsDirty(viewport.i, MATRIX_VIEW_SIZE);
 }
 
 /**
- * @brief Función auxiliar para mostrar/ocultar bitblockbuffers.
+ * @brief Función auxiliar para mostrar/ocultar bitblockbuffers. Las celdas que quedan fuera de
+ * la forma en uso no se muestran nunca.
  * @param hide
  */
 void matrix_hideBitBlockBuffer(bool hide){
@@ -133,12 +326,10 @@ void matrix_hideBitBlockBuffer(bool hide){
     else
         isBufferHidden = false;
 
-    for(int i = 0; i < BITBLOCK_SIZE; i++)
-        for (int j = 0; j < BITBLOCK_SIZE; j++)
-            sprites_displaySprite(bitBlockBuffer[i][j]->sprite->index,
-                                  MATRIX_X_POS + (j * MATRIX_X_PADDING),
-                                  MATRIX_Y_POS + (i * MATRIX_Y_PADDING),
-                                  hide);
+    for(int i = 0; i < BITBLOCK_ROWS; i++)
+        for (int j = 0; j < BITBLOCK_COLS; j++)
+            matrix_displayCell(bitBlockSprites[i][j], BITBOARD_GET(bitBlockBuffer[i], BITBLOCK_COLS, j),
+                               i, j, hide || !(shapeViewMasks[i] & BIT(j)));
 }
 
 
@@ -153,45 +344,81 @@ void matrix_hideBitBlockBuffer(bool hide){
 /**
  * @brief Función que será llamada en la frecuencia determinada por el eventMgr con objeto
  * de mostrar la animación de la matriz entera cayendo.
- * @return TRUE si todos los elementos de la matriz (@struct MatrixElement) están fuera de la pantalla
+ * @return TRUE si todos los sprites de la matriz están fuera de la pantalla
  * y FALSE en caso contrario.
  */
 bool matrix_destroyMatrixEffect(){
 
-    for(int i = 0; i < MATRIX_SIZE; i++)
-        for(int j = 0; j < MATRIX_SIZE; j++)
-            if((matrix[i][j]->sprite != NULL)
-            && (matrix[i][j]->sprite->spriteEntry->y <= WINDOW_HEIGHT))
-                matrix[i][j]->sprite->spriteEntry->y +=2;
+    for(int i = 0; i < MATRIX_VIEW_SIZE; i++)
+        for(int j = 0; j < MATRIX_VIEW_SIZE; j++)
+            if(sprites_getSpriteEntryByIndex(matrixSprites[i][j])->y <= WINDOW_HEIGHT)
+                sprites_getSpriteEntryByIndex(matrixSprites[i][j])->y +=2;
 
-    return matrix[MATRIX_FIRST][MATRIX_FIRST]->sprite->spriteEntry->y <= WINDOW_HEIGHT;
+    return sprites_getSpriteEntryByIndex(matrixSprites[MATRIX_FIRST][MATRIX_FIRST])->y <= WINDOW_HEIGHT;
 }
 
 /**
  * @todo: Hacer esto con puntero a función y reducir código
  * @brief Función que será llamada en la frecuencia determinada por el eventMgr con objeto
- * de mostrar la animación del bloque de bits cayendo.
- * @return TRUE si todos los elementos del bitblock (@struct MatrixElement) están fuera de la pantalla
+ * de mostrar la animación del bloque de bits cayendo. Solo caen las celdas de la forma en uso.
+ * @return TRUE mientras quede algún sprite de la forma dentro de la pantalla
  * y FALSE en caso contrario.
  */
 bool matrix_dropBitBlockEffect(){
     int out = 0;
-    for(int i = -1; i <= 1; i++)
-        for(int j = -1; j <= 1; j++)
-            if(matrix[pivot->i + i][pivot->j + j]->sprite->spriteEntry->y >= WINDOW_HEIGHT)
+    for(int i = 0; i < BITBLOCK_ROWS; i++)
+        for(ViewMask cols = shapeViewMasks[i]; cols; cols &= cols - 1){
+            SpriteEntry* entry = matrix_getCellEntry(pivot->i - BITBLOCK_TOP + i,
+                                                     pivot->j - BITBLOCK_LEFT + __builtin_ctz(cols));
+            if(entry->y >= WINDOW_HEIGHT)
                 out++;
             else
-                matrix[pivot->i + i][pivot->j + j]->sprite->spriteEntry->y +=2;
-    return out != MATRIX_BLOCK;
+                entry->y +=2;
+        }
+    return out != shapeCells;
 }
 
 /**
- * @brief Función pendiente si tengo tiempo. Animación especial  para la regeneración del bloque de bits
- * @return
+ * @brief Animación del colapso por gravedad (ver @fn matrix_collapseBitBlock). La matriz ya está
+ * actualizada: cada frame únicamente se reduce el desplazamiento de las columnas que caen y se
+ * marcan para volver a pintarlas las celdas de encima de su hueco.
+ * @return TRUE mientras quede alguna columna cayendo, FALSE cuando han llegado todas.
  */
-bool matrix_bitConjuctionEffect(){
+bool matrix_collapseEffect(){
+    ViewMask falling = collapseColumns;
 
-    return true;
+    for(ViewMask cols = falling; cols; cols &= cols - 1){
+        uint8 j = __builtin_ctz(cols);
+
+        collapseOffset[j] = collapseOffset[j] > COLLAPSE_STEP ? collapseOffset[j] - COLLAPSE_STEP : 0;
+        if(collapseOffset[j] == 0)
+            collapseColumns &= ~BIT(j);
+        for(int i = 0; i <= collapseLastRows[j] - viewport.i && i < MATRIX_VIEW_SIZE; i++)
+            matrix_markViewDirty(i, BIT(j));
+    }
+
+    return collapseColumns != 0;
+}
+
+/**
+ * @brief Animación de la regeneración de la matriz (ver @fn matrix_regenerateMatrix): cada frame
+ * aparece una fila más del viewport, de arriba abajo, y se refrescan las ventanas de
+ * @def MATRIX_REVEAL_WINDOW_ROWS filas de la matriz. Así el trabajo de cada frame es como mucho una
+ * fila de sprites y unas pocas filas de ventanas, sea cual sea el tamaño de la matriz.
+ * @return TRUE mientras quede algo por mostrar o refrescar, FALSE cuando la matriz está lista.
+ */
+bool matrix_revealMatrixEffect(){
+    uint8 count = matrixSize - revealWindowsRow;
+
+    if(count > MATRIX_REVEAL_WINDOW_ROWS)
+        count = MATRIX_REVEAL_WINDOW_ROWS;
+    matrix_refreshRowWindows(revealWindowsRow, count);
+    revealWindowsRow += count;
+
+    if(revealRow < MATRIX_VIEW_SIZE)
+        matrix_markViewDirty(revealRow++, VIEW_MASK_ALL);
+
+    return (revealRow < MATRIX_VIEW_SIZE) || (revealWindowsRow < matrixSize);
 }
 
 /**
@@ -200,7 +427,7 @@ bool matrix_bitConjuctionEffect(){
  * @param state
  */
 void matrix_bitShakeEffect(int8 state){
-    matrix[pivot->i][pivot->j]->sprite->spriteEntry->x = (MATRIX_X_POS + (pivot->j * MATRIX_X_PADDING))+(state * 2);
+    matrix_getCellEntry(pivot->i, pivot->j)->x = matrix_getPositionX(pivot->j - viewport.j) + (state * 2);
 }
 
 /**
@@ -209,7 +436,7 @@ void matrix_bitShakeEffect(int8 state){
  * mientras el bit se está desplazando. Ésta función ayuda a solventar ese problema.
  */
 void matrix_bitResetPosEffect(){
-    matrix[pivot->i][pivot->j]->sprite->spriteEntry->x = (MATRIX_X_POS + (pivot->j * MATRIX_X_PADDING));
+    matrix_getCellEntry(pivot->i, pivot->j)->x = matrix_getPositionX(pivot->j - viewport.j);
 }
 
 /*
@@ -222,29 +449,77 @@ void matrix_bitResetPosEffect(){
 
 /**
  * @brief Regenera el bloque de bits una vez destruido por el usuario.
-* 1. Permutar elementos del bitBlockBuffer.
-* 2. Salvar en un array temporal los MatrixElement (sprite+ digit).
-* 3. Asignar referencias de elementos MatrixElement del bitBlockBuffer a la matriz (i,j).
-* 4. Colocar esos elementos de matrix en las posiciones correctas (ya que son los que han caído).
-* 5. Asignar las referencias guardadas en el array temporal al bitBlockBuffer.
-* 6. Mostrar elementos nuevos de la matriz (en base al pivot).
-* @todo: Permutar elementos de bitBlockBuffer
+* 1. Sustituir, en cada fila afectada del bitboard, las celdas de la forma en uso bajo el pivot
+*    (@var shapeRowMasks) por las del bitBlockBuffer (lo destruido se descarta).
+* 2. Marcar las celdas afectadas para volver a pintarlas (sus sprites son los que han caído).
+* 3. Cargar en el bitBlockBuffer el siguiente bloque, ya permutado, del ring de matrixPool.c.
+* 4. Refrescar la caché de ventanas de las filas afectadas y actualizar los mapas de overflow
+*    en el entorno del pivot.
 */
 void matrix_regenerateBitBlock(){
 
-    MatrixElement* tmp[BITBLOCK_SIZE][BITBLOCK_SIZE];
-
-    for(int i = -1; i <= 1; i++){
-        for(int j = -1; j <= 1; j++){
-            tmp[i+1][j+1] = matrix[pivot->i + i][pivot->j + j];
-            matrix[pivot->i + i][pivot->j + j] = bitBlockBuffer[i+1][j+1];
-            bitBlockBuffer[i+1][j+1] = tmp[i+1][j+1];
-            sprites_displaySprite(matrix[pivot->i + i][pivot->j + j]->sprite->index,
-                                  MATRIX_X_POS + ((pivot->j + j) * MATRIX_X_PADDING),
-                                  MATRIX_Y_POS + ((pivot->i + i) * MATRIX_Y_PADDING),
-                                  false);
+    uint8 shift = BITBLOCK_SHIFT(matrixSize, pivot->j);
+
+    for(int i = -BITBLOCK_TOP; i <= BITBLOCK_BOTTOM; i++){
+        BitboardRow mask = shapeRowMasks[i + BITBLOCK_TOP];
+
+        if(!mask)
+            continue;
+        matrix[pivot->i + i] = (matrix[pivot->i + i] & ~(mask << shift))
+                               | ((bitBlockBuffer[i + BITBLOCK_TOP] & mask) << shift);
+        matrix_markViewDirty(pivot->i + i - viewport.i,
+                             shapeViewMasks[i + BITBLOCK_TOP] << (pivot->j - BITBLOCK_LEFT - viewport.j));
+    }
+
+    matrixPool_consumeBitBlock(bitBlockBuffer);
+    matrix_refreshRowWindows(pivot->i - BITBLOCK_TOP, BITBLOCK_ROWS);
+    matrix_updateOverflowMaps(pivot->i, pivot->j);
+}
+
+/**
+ * @brief Alternativa a @fn matrix_regenerateBitBlock en el modo @enum COLLAPSE_GRAVITY: las celdas
+ * que hay encima de la forma destruida caen para rellenar el hueco y las celdas de la forma del
+ * bitBlockBuffer aparecen arriba del todo.
+ *
+ * Las columnas de un mismo grupo de caída (@var shapeFallMasks: misma primera fila y altura en la
+ * forma) forman en cada fila del bitboard un mismo campo, así que hacer caer todas a la vez es
+ * copiar ese campo de la fila r - altura a la fila r, de abajo arriba: una máscara por fila y
+ * grupo, sin tocar celda a celda. Con el bloque completo hay un único grupo.
+ *
+ * La animación se reduce a un desplazamiento por columna del viewport (@var collapseOffset): las
+ * celdas ya muestran su nuevo dígito, pero se pintan @def COLLAPSE_FALL píxeles más arriba y
+ * @fn matrix_collapseEffect las va bajando.
+ */
+void matrix_collapseBitBlock(){
+    uint8 shift = BITBLOCK_SHIFT(matrixSize, pivot->j);
+    uint8 left = pivot->j - BITBLOCK_LEFT;
+
+    collapseColumns = 0;
+    for(int k = 0; k < shapeFalls; k++){
+        BitboardRow mask = ((BitboardRow) shapeFallMasks[k]) << shift;
+        uint8 height = shapeFallHeight[k];
+        uint8 bottom = pivot->i - BITBLOCK_TOP + shapeFallTop[k] + height - 1;
+        ViewMask cols = shapeFallViewMasks[k] << (left - viewport.j);
+
+        for(int r = bottom; r >= height; r--)
+            matrix[r] = (matrix[r] & ~mask) | (matrix[r - height] & mask);
+        for(int r = 0; r < height; r++)
+            matrix[r] = (matrix[r] & ~mask) | ((bitBlockBuffer[shapeFallTop[k] + r] << shift) & mask);
+
+        collapseColumns |= cols;
+        for(; cols; cols &= cols - 1){
+            uint8 j = __builtin_ctz(cols);
+
+            collapseOffset[j] = COLLAPSE_FALL(height);
+            collapseLastRows[j] = bottom;
+            for(int i = 0; i <= bottom - viewport.i && i < MATRIX_VIEW_SIZE; i++)
+                matrix_markViewDirty(i, BIT(j));
         }
     }
+
+    matrixPool_consumeBitBlock(bitBlockBuffer);
+    matrix_refreshRowWindows(0, pivot->i + BITBLOCK_BOTTOM + 1);
+    matrix_updateOverflowRegion(0, pivot->i + BITBLOCK_BOTTOM, left, pivot->j + BITBLOCK_RIGHT);
 }
 
 /**
@@ -254,78 +529,146 @@ void matrix_regenerateBitBlock(){
  * Para ello, permuto la matriz con algoritmo de Fisher-Yates algoritmo (1938),
  * versión moderna por Durstenfeld (1964).
  *
+ * Todo el trabajo se hace sobre el bitboard, los sprites no se mueven: al volver
+ * a mostrar la matriz cada celda pinta el dígito que le corresponda.
  *
- * 1. Transpongo matriz.
- * 2. Cambio de base a array 1D.
- * 3. Permuto con algoritmo de Durstenfeld.
- * 4. Cambio de base a 2D.
+ * Antes se transponía la matriz y después se permutaba, pero componer una permutación
+ * uniforme con la transposición sigue siendo una permutación uniforme; así que ambas se
+ * reducen a una única permutación de todas las celdas (incluida la fila 0), aplicada in situ.
+ *
+ * La matriz ya viene generada desde el pool (ver matrixPool.c), con una densidad de overflows
+ * dentro de la banda de cada dificultad, y aquí solo se copia. El resto (ventanas y sprites) se
+ * reparte entre los frames siguientes, fila a fila, ver @fn matrix_revealMatrixEffect.
  */
 void matrix_regenerateMatrix(){
+    matrixPool_consume();
+    isMatrixHidden = false;
+    revealRow = 0;
+    revealWindowsRow = 0;
+}
 
-    MatrixElement* matrix1D[MATRIX_SIZE * MATRIX_SIZE];
-    matrix_transposeMainMatrix();
-
-    for(int i = 0; i < MATRIX_SIZE; i++){
-        for(int j = 0; j < MATRIX_SIZE; j++){
-            matrix1D[(i*MATRIX_SIZE) +j] = matrix[i][j];
-        }
-    }
+/**
+ * @brief Recalcula todo lo que se deriva de la matriz, el buffer y el pivot después de sustituirlos
+ * desde fuera (p.ej. al restaurar un snapshot): caché de ventanas, mapas de overflow y viewport.
+ * No reserva memoria ni toca los sprites, únicamente los marca para el siguiente frame.
+ */
+void matrix_reloadState(){
+    revealRow = MATRIX_VIEW_SIZE;
+    revealWindowsRow = matrixSize;
+    matrix_refreshRowWindows(0, matrixSize);
+    matrix_rebuildOverflowMaps();
+    viewport.i = viewport.j = 0;
+    matrix_scrollViewport(pivot->i, pivot->j);
+    matrix_markRowsDirty(0, matrixSize);
+}
 
-    matrix_permuteMatrix(matrix1D);
+/**
+ * @brief Permuta la matriz principal con algoritmo de Fisher-Yates algoritmo (1938),
+ * versión moderna por Durstenfeld (1964), sobre todas las celdas y con @var gameRng.
+ *
+ * La regeneración de la partida ya no pasa por aquí (saca matrices ya permutadas del pool, ver
+ * @fn matrix_regenerateMatrix); se mantiene para permutar la matriz en uso fuera del pool. Deja al
+ * día la caché de ventanas, los mapas de overflow y las celdas a repintar.
+ */
+void matrix_permuteMatrix(){
+    matrix_shuffleBitboard(&gameRng, matrix, matrixSize, matrixSize);
+    matrix_refreshRowWindows(0, matrixSize);
+    matrix_rebuildOverflowMaps();
+    matrix_markRowsDirty(0, matrixSize);
+}
 
-    int i = 0;
-    int j = 0;
+/**
+ * @brief Permuta in situ y de manera uniforme todas las celdas de un bitboard (Durstenfeld):
+ * genera la secuencia de intercambios (@fn matrix_drawPermutation) y la aplica
+ * (@fn matrix_applyPermutation). No necesita ninguna copia temporal de la matriz.
+ * @param rng Generador a utilizar.
+ * @param rows Bitboard a permutar (matriz principal, bitBlockBuffer...).
+ * @param height Número de filas del bitboard.
+ * @param width Número de columnas del bitboard.
+ */
+void matrix_shuffleBitboard(RngState* rng, BitboardRow* rows, uint8 height, uint8 width){
+    uint16 swaps[MATRIX_MAX_CELLS];
 
-    for(int k = 0; k < MATRIX_SIZE*(MATRIX_SIZE-1); k++){
-       if((k % MATRIX_SIZE) == 0){
-           i++;
-           j = 0;
-       }
-       matrix[i][j] = matrix1D[(i*MATRIX_SIZE) +j];
-       j++;
-    }
+    matrix_drawPermutation(rng, swaps, height * width);
+    matrix_applyPermutation(rows, height, width, swaps);
 }
 
-/*
- * @brief Transpone la matriz (cambio de filas por columnas).
+/**
+ * @brief Genera una permutación uniforme en forma de secuencia de intercambios de Durstenfeld:
+ * swaps[k] (con k de cells-1 a 1) es la celda, en [0, k], con la que se intercambia la celda k.
+ *
+ * Los índices se sacan de dos en dos de cada número de rng (Brackett-Rozinsky y Lemire, 2024): con
+ * x * (k + 1) la parte alta es swaps[k] y la baja, multiplicada por k, da swaps[k - 1]. Si lo que
+ * sobra de la segunda multiplicación cae en la zona sesgada (probabilidad menor que 2^-12) se repite
+ * con otro número, así que el resultado es tan uniforme como con @fn rng_bounded, con la mitad de
+ * números.
+ * @param rng Generador a utilizar.
+ * @param swaps Vector destino de tamaño cells.
+ * @param cells Número de celdas a permutar, como mucho @def MATRIX_MAX_CELLS.
  */
-void matrix_transposeMainMatrix(){
+void matrix_drawPermutation(RngState* rng, uint16* swaps, uint16 cells){
+    int k = cells - 1;
 
-    MatrixElement* tmpMatrix[MATRIX_SIZE][MATRIX_SIZE];
+    swaps[0] = 0;
+    for(; k > 1; k -= 2){
+        uint32 bound = (k + 1) * k;
+        uint64 high = (uint64) rng_next(rng) * (k + 1);
+        uint64 low = (uint64) (uint32) high * k;
 
-    for(int i = 0; i < MATRIX_SIZE; i++){
-        for(int j = 0; j < MATRIX_SIZE; j++){
-            tmpMatrix[i][j] = matrix[i][j];
-        }
-    }
+        if((uint32) low < bound){
+            uint32 threshold = -bound % bound;
 
-    for(int i = 0; i < MATRIX_SIZE; i++){
-        for(int j = 0; j < MATRIX_SIZE; j++){
-           matrix[i][j] = tmpMatrix[j][i];
+            while((uint32) low < threshold){
+                high = (uint64) rng_next(rng) * (k + 1);
+                low = (uint64) (uint32) high * k;
+            }
         }
+        swaps[k] = high >> 32;
+        swaps[k - 1] = low >> 32;
     }
+    if(k == 1)
+        swaps[1] = rng_bounded(rng, 2);
 }
 
 /**
- * @brief Permuta la matriz con algoritmo de Fisher-Yates algoritmo (1938),
- * versión moderna por Durstenfeld (1964).
- * @param matrix1D La matriz en 2D transformada en un vector para una mejor permutación.
+ * @brief Aplica in situ sobre un bitboard una permutación en forma de secuencia de intercambios
+ * (ver @fn matrix_drawPermutation). La celda k del vector 1D equivale a la celda (k / width, k % width).
+ *
+ * La celda k se recorre hacia atrás fila a fila y la fila de swaps[k] se saca con
+ * @def BITBOARD_ROW_OF, así que el bucle no divide. La fila de k se queda en un registro hasta
+ * terminarla (swaps[k] <= k, así que la otra celda solo cae en ella si es la misma fila), y
+ * intercambiar dos bits es invertir ambos si son distintos: un XOR de su diferencia, sin saltos.
+ * @param rows Bitboard a permutar.
+ * @param height Número de filas del bitboard.
+ * @param width Número de columnas del bitboard.
+ * @param swaps Secuencia de intercambios, de height * width celdas.
  */
-void matrix_permuteMatrix(MatrixElement* matrix1D[]){
+void matrix_applyPermutation(BitboardRow* rows, uint8 height, uint8 width, const uint16* swaps){
+    uint32 reciprocal = BITBOARD_RECIPROCAL(width);
+    uint8 i = height - 1, j = width - 1;
+    BitboardRow row = rows[i];
 
-    int upper = (MATRIX_SIZE*MATRIX_SIZE) - 1;
-    srand(time(0));
+    for(int k = (height * width) - 1; k > 0; k--){
+        uint8 ri = BITBOARD_ROW_OF(swaps[k], reciprocal);
+        uint8 rj = swaps[k] - ri * width;
+        BitboardRow diff;
+
+        if(ri == i){
+            diff = BITBOARD_GET(row, width, j) ^ BITBOARD_GET(row, width, rj);
+            row ^= (diff << BITBOARD_SHIFT(width, j)) | (diff << BITBOARD_SHIFT(width, rj));
+        }else{
+            diff = BITBOARD_GET(row, width, j) ^ BITBOARD_GET(rows[ri], width, rj);
+            row ^= diff << BITBOARD_SHIFT(width, j);
+            rows[ri] ^= diff << BITBOARD_SHIFT(width, rj);
+        }
 
-    while(upper > 10 ){
-        MatrixElement* tmp;
-        int r = (rand() % upper);
-        if(r >= MATRIX_SIZE){
-            tmp = matrix1D[r];
-            matrix1D[r] = matrix1D[upper];
-            matrix1D[upper] = tmp;
-            upper--;
+        if(j-- == 0){
+            rows[i] = row;
+            j = width - 1;
+            row = rows[--i];
         }
     }
+    rows[i] = row;
 }
 
 /*
@@ -344,31 +687,455 @@ void matrix_permuteMatrix(MatrixElement* matrix1D[]){
  * @param j columna.
  */
 void matrix_updatePivot(uint8 i, uint8 j){
-    if((i >= 1) && (i < MATRIX_SIZE-1) && (j >= 1) && (j < MATRIX_SIZE-1)){
+    if((i >= MATRIX_FIRST_PIVOT_I) && (i <= MATRIX_LAST_PIVOT_I(matrixSize))
+    && (j >= MATRIX_FIRST_PIVOT_J) && (j <= MATRIX_LAST_PIVOT_J(matrixSize))){
         pivot->i = i;
         pivot->j = j;
     }
 }
 
 /**
- * @brief Función encargada de evaluar si existe overflow o no. Analiza cada fila,
- * tratando la combinación de sus bits como un número en binario, de manera que
+ * @brief Función encargada de evaluar si existe overflow o no. Con la regla original analiza
+ * cada fila, tratando la combinación de sus bits como un número en binario, de manera que
  * si la suma de los números binarios resultantes de cada fila del bloque de bits es
  * superior al overflow definido al comienzo del juego (pastilla azul/roja), genera
- * overflow o no.
+ * overflow o no. El resto de reglas leen el bloque de otra forma, ver @enum OverflowRule.
  * @return TRUE si existe Overflow, FALSE en caso contrario.
  */
 bool matrix_evalBitBlockOverflow(){
-    int decValue = 0;
-    for(int i = -1; i <= 1; i++){
-        double power = BITBLOCK_SIZE - 1;
-        for(int j = -1; j <= 1; j++){
-            decValue += matrix[pivot->i + i][pivot->j + j]->bit * pow(2, power);
-            power--;
+    return matrix_evalBitBlock(matrix_getBitBlockPattern(pivot->i, pivot->j))
+           & BITBLOCK_OVERFLOW_FLAG(gameData.mode);
+}
+
+/**
+ * @brief Obtiene el patrón de @def BITBLOCK_CELLS bits del bloque cuyo pivot es (i, j), fila
+ * superior en los bits más significativos. Se monta con las ventanas de la caché @var rowWindows
+ * (una lectura y un desplazamiento por fila), ver @def BITBLOCK_WINDOWS_PATTERN.
+ * @param i fila del pivot.
+ * @param j columna del pivot.
+ * @return Patrón del bloque, índice válido para @var bitBlockTable.
+ */
+uint16 matrix_getBitBlockPattern(uint8 i, uint8 j){
+    return BITBLOCK_WINDOWS_PATTERN(rowWindows, i, j);
+}
+
+/**
+ * @brief Vuelve a extraer las ventanas de @var rowWindows de las filas [first, first + count)
+ * de la matriz. Hay que llamarla cada vez que cambian esas filas.
+ * La ventana del último pivot son los bits bajos de la fila; de ahí hacia la izquierda, cada
+ * columna de pivot está un bit más arriba.
+ * @param first Primera fila a refrescar.
+ * @param count Número de filas.
+ */
+void matrix_refreshRowWindows(uint8 first, uint8 count){
+    for(int i = first; i < first + count; i++){
+        BitboardRow row = matrix[i];
+
+        for(int j = MATRIX_LAST_PIVOT_J(matrixSize); j >= MATRIX_FIRST_PIVOT_J; j--){
+            rowWindows[i][j] = row & BITBLOCK_MASK;
+            row >>= 1;
         }
     }
+}
+
+/**
+ * @brief Evalúa un bloque de bits con la regla de overflow y la forma en uso. Con la tabla precalculada es un
+ * único acceso; si el bloque es demasiado grande para tabularlo, se calcula la entrada a partir de
+ * los campos de sus filas (ver @def BITBLOCK_LOOKUP_TABLE).
+ * @param pattern Patrón del bloque.
+ * @return Entrada de evaluación: valor del bloque (@def BITBLOCK_VALUE_MASK) y veredictos
+ * de overflow de cada dificultad (@def BITBLOCK_OVERFLOW_FLAG).
+ */
+uint8 matrix_evalBitBlock(uint16 pattern){
+#if BITBLOCK_LOOKUP_TABLE
+    return bitBlockTable[pattern];
+#else
+    uint16 mask = bitBlockShapeMasks[gameData.shape];
+
+    switch(gameData.rule){
+        case OVERFLOW_RULE_COLUMNS:
+            return BITBLOCK_COLUMNS_ENTRY(pattern, mask);
+        case OVERFLOW_RULE_DIAGONALS:
+            return BITBLOCK_DIAGONALS_ENTRY(pattern, mask);
+        case OVERFLOW_RULE_SIGNED_ROWS:
+            return BITBLOCK_SIGNED_ENTRY(pattern, mask);
+        case OVERFLOW_RULE_ANY_ROW:
+            return BITBLOCK_ANY_ROW_ENTRY(pattern, mask);
+        default:
+            return BITBLOCK_ENTRY(pattern, mask);
+    }
+#endif
+}
+
+/**
+ * @brief Cambia la regla de overflow y la forma de selección en uso. Todas las tablas están
+ * generadas en tiempo de compilación, así que cambiar de regla o de forma es cambiar el puntero a
+ * la tabla; después se carga la forma (@fn matrix_loadBitBlockShape) y se rehacen los mapas de
+ * overflow de la matriz actual.
+ * La regla y la forma activas son las de @var gameData, ver @fn game_setBitBlockEvaluation.
+ * @param rule regla, @enum OverflowRule.
+ * @param shape forma, @enum BitBlockShape.
+ */
+void matrix_selectBitBlockEvaluation(uint8 rule, uint8 shape){
+#if BITBLOCK_LOOKUP_TABLE
+    bitBlockTable = bitBlockRuleTables[rule][shape];
+#else
+    (void) rule; // La suma de filas lee la regla de @var gameData en cada evaluación.
+#endif
+    matrix_loadBitBlockShape(shape);
+    matrix_rebuildOverflowMaps();
+}
+
+/**
+ * @brief Desglosa la máscara de una forma (@var bitBlockShapeMasks) en las filas, columnas y grupos
+ * de caída que recorren la regeneración, el colapso y las animaciones del bloque, de manera que
+ * ninguna de ellas tenga que comprobar celda a celda si pertenece a la forma.
+ * Las columnas con la misma primera fila y altura caen juntas (@var shapeFallMasks): en el bloque
+ * completo es un único grupo, como antes de haber formas.
+ * @param shape forma, @enum BitBlockShape.
+ */
+void matrix_loadBitBlockShape(uint8 shape){
+    uint16 mask = bitBlockShapeMasks[shape];
+
+    shapeCells = __builtin_popcount(mask);
+    shapeFalls = 0;
+
+    for(int r = 0; r < BITBLOCK_ROWS; r++){
+        shapeRowMasks[r] = (mask >> BITBLOCK_ROW_SHIFT(r)) & BITBLOCK_MASK;
+        shapeViewMasks[r] = 0;
+        for(int c = 0; c < BITBLOCK_COLS; c++)
+            if(shapeRowMasks[r] & BIT(BITBLOCK_COL_SHIFT(c)))
+                shapeViewMasks[r] |= BIT(c);
+    }
+
+    for(int c = 0; c < BITBLOCK_COLS; c++){
+        uint8 top = 0, height = 0;
+        int k = 0;
+
+        for(int r = 0; r < BITBLOCK_ROWS; r++){
+            if(!(shapeRowMasks[r] & BIT(BITBLOCK_COL_SHIFT(c))))
+                continue;
+            if(height == 0)
+                top = r;
+            height++;
+        }
+        if(height == 0)
+            continue;
+
+        while(k < shapeFalls && (shapeFallTop[k] != top || shapeFallHeight[k] != height))
+            k++;
+        if(k == shapeFalls){
+            shapeFallMasks[k] = 0;
+            shapeFallViewMasks[k] = 0;
+            shapeFallTop[k] = top;
+            shapeFallHeight[k] = height;
+            shapeFalls++;
+        }
+        shapeFallMasks[k] |= BIT(BITBLOCK_COL_SHIFT(c));
+        shapeFallViewMasks[k] |= BIT(c);
+    }
+}
+
+/**
+ * @brief Evalúa de una pasada (SWAR, ver @fn matrix_buildOverflowMap) todos los pivots válidos de la
+ * matriz principal con la regla, la forma y la dificultad actuales. No toca @var pivot ni los mapas
+ * persistentes, así que se puede llamar también desde la rutina de atención del timer.
+ *
+ * Como el tamaño de la matriz es variable, el resultado no es una máscara de 64 bits sino un
+ * @struct OverflowMap: una máscara por fila de pivots, ver @def OVERFLOW_ROW_BIT.
+ * @param map Mapa destino, con un bit a 1 por cada pivot que genera overflow.
+ */
+void matrix_computeOverflowMap(OverflowMap* map){
+    OverflowMap maps[OVERFLOW_MAPS];
+
+    if(gameData.rule == OVERFLOW_RULE_ROWS && gameData.shape == BITBLOCK_SHAPE_SQUARE){
+        matrix_buildOverflowMap(matrix, matrixSize, matrix_getOverflowLimit(), map);
+        return;
+    }
+
+    matrix_buildRuleOverflowMaps(matrix, matrixSize, maps);
+    *map = maps[gameData.mode];
+}
+
+/**
+ * @brief Evalúa de una pasada todos los pivots válidos de la matriz, sin tocar @var pivot
+ * (se puede usar desde cualquier contexto, incluida la rutina de atención del timer).
+ *
+ * Por cada grupo de 8 columnas de pivot se recorren las filas manteniendo, carril a carril, la suma
+ * de las ventanas de las @def BITBLOCK_ROWS filas del bloque: se suma la fila que entra y se resta
+ * la que sale (ningún carril baja de 0, así que no hay acarreos entre carriles). Sumando a cada
+ * carril (0x7F - límite), el bit alto de un carril queda a 1 si y solo si su valor supera el límite
+ * (el máximo, 63 + 0x7F, no desborda el carril; los carriles sin pivot valen 0 y nunca lo superan).
+ * El coste es lineal en el número de celdas e independiente del número de filas del bloque.
+ * @param rows Bitboard de la matriz a evaluar (no tiene por qué ser la principal).
+ * @param size Número de filas/columnas del bitboard.
+ * @param limit Valor a partir del cual (sin incluirlo) se considera overflow.
+ * @param map Mapa destino, con un bit a 1 por cada pivot que genera overflow, ver @def OVERFLOW_ROW_BIT.
+ */
+void matrix_buildOverflowMap(const BitboardRow* rows, uint8 size, uint8 limit, OverflowMap* map){
+    uint64 bias = SWAR_LANES_LOW * (0x7F - limit);
+
+    for(int i = 0; i < MATRIX_MAX_SIZE; i++)
+        map->rows[i] = 0;
+
+    for(int first = MATRIX_FIRST_PIVOT_J; first <= MATRIX_LAST_PIVOT_J(size); first += SWAR_LANES){
+        uint64 sum = 0;
+
+        for(int r = 0; r < BITBLOCK_ROWS - 1; r++)
+            sum += matrix_getRowWindows(rows[r], size, first);
+
+        for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(size); i++){
+            sum += matrix_getRowWindows(rows[i + BITBLOCK_BOTTOM], size, first);
+            map->rows[i] |= (OverflowRow) matrix_gatherLaneVerdicts(sum + bias)
+                            << (first - MATRIX_FIRST_PIVOT_J);
+            sum -= matrix_getRowWindows(rows[i - BITBLOCK_TOP], size, first);
+        }
+    }
+}
+
+/**
+ * @brief Reconstruye por completo los mapas de overflow persistentes. Únicamente necesario
+ * cuando cambia toda la matriz (inicialización y regeneración).
+ */
+void matrix_rebuildOverflowMaps(){
+    matrix_buildOverflowMaps(matrix, matrixSize, overflowMaps);
+}
+
+/**
+ * @brief Calcula los mapas de overflow de ambas dificultades de un bitboard cualquiera.
+ * @param rows Bitboard de la matriz a evaluar.
+ * @param size Número de filas/columnas del bitboard.
+ * @param maps Vector destino de OVERFLOW_MAPS elementos, indexado por @enum Difficulty.
+ */
+void matrix_buildOverflowMaps(const BitboardRow* rows, uint8 size, OverflowMap* maps){
+    if(gameData.rule != OVERFLOW_RULE_ROWS || gameData.shape != BITBLOCK_SHAPE_SQUARE){
+        matrix_buildRuleOverflowMaps(rows, size, maps);
+        return;
+    }
 
-    return decValue > matrix_getOverflowLimit();
+    matrix_buildOverflowMap(rows, size, OVERFLOW_NM, &maps[DIFFICULTY_NORMAL_MODE]);
+    matrix_buildOverflowMap(rows, size, OVERFLOW_HM, &maps[DIFFICULTY_HARD_MODE]);
+}
+
+/**
+ * @brief Calcula los mapas de overflow de ambas dificultades con la regla en uso evaluando cada
+ * pivot con su tabla (@fn matrix_evalBitBlock). La suma por carriles de @fn matrix_buildOverflowMap
+ * solo sirve para la regla de las filas con el bloque completo; el resto de reglas y formas pasan por aquí.
+ * @param rows Bitboard de la matriz a evaluar.
+ * @param size Número de filas/columnas del bitboard.
+ * @param maps Vector destino de OVERFLOW_MAPS elementos, indexado por @enum Difficulty.
+ */
+void matrix_buildRuleOverflowMaps(const BitboardRow* rows, uint8 size, OverflowMap* maps){
+    for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+        for(int i = 0; i < MATRIX_MAX_SIZE; i++)
+            maps[mode].rows[i] = 0;
+
+    for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(size); i++){
+        for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(size); j++){
+            uint8 entry = matrix_evalBitBlock(BITBLOCK_PATTERN(rows, i, BITBLOCK_SHIFT(size, j)));
+            for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+                if(entry & BITBLOCK_OVERFLOW_FLAG(mode))
+                    maps[mode].rows[i] |= OVERFLOW_ROW_BIT(j);
+        }
+    }
+}
+
+/**
+ * @brief Actualiza los mapas de overflow tras modificar el bloque del pivot (i, j). Solo
+ * pueden cambiar de veredicto los pivots cuyo bloque se solapa con él, por lo que el coste es
+ * constante (a lo sumo (2 * filas - 1) x (2 * columnas - 1) evaluaciones, 5x5 en el 3x3)
+ * independientemente del tamaño de la matriz.
+ * @param i fila del pivot del bloque modificado.
+ * @param j columna del pivot del bloque modificado.
+ */
+void matrix_updateOverflowMaps(uint8 i, uint8 j){
+    matrix_updateOverflowRegion(i - BITBLOCK_TOP, i + BITBLOCK_BOTTOM, j - BITBLOCK_LEFT, j + BITBLOCK_RIGHT);
+}
+
+/**
+ * @brief Actualiza los mapas de overflow tras modificar un rectángulo cualquiera de celdas: se
+ * vuelven a evaluar únicamente los pivots cuyo bloque se solapa con él.
+ * @param top primera fila modificada.
+ * @param bottom última fila modificada.
+ * @param left primera columna modificada.
+ * @param right última columna modificada.
+ */
+void matrix_updateOverflowRegion(uint8 top, uint8 bottom, uint8 left, uint8 right){
+    uint8 firstI = top > MATRIX_FIRST_PIVOT_I + BITBLOCK_BOTTOM ? top - BITBLOCK_BOTTOM : MATRIX_FIRST_PIVOT_I;
+    uint8 firstJ = left > MATRIX_FIRST_PIVOT_J + BITBLOCK_RIGHT ? left - BITBLOCK_RIGHT : MATRIX_FIRST_PIVOT_J;
+    uint8 lastI = bottom + BITBLOCK_TOP < MATRIX_LAST_PIVOT_I(matrixSize) ? bottom + BITBLOCK_TOP
+                                                                          : MATRIX_LAST_PIVOT_I(matrixSize);
+    uint8 lastJ = right + BITBLOCK_LEFT < MATRIX_LAST_PIVOT_J(matrixSize) ? right + BITBLOCK_LEFT
+                                                                          : MATRIX_LAST_PIVOT_J(matrixSize);
+
+    for(int pi = firstI; pi <= lastI; pi++){
+        for(int pj = firstJ; pj <= lastJ; pj++){
+            uint8 entry = matrix_evalBitBlock(matrix_getBitBlockPattern(pi, pj));
+            for(int mode = 0; mode < OVERFLOW_MAPS; mode++){
+                if(entry & BITBLOCK_OVERFLOW_FLAG(mode))
+                    overflowMaps[mode].rows[pi] |= OVERFLOW_ROW_BIT(pj);
+                else
+                    overflowMaps[mode].rows[pi] &= ~OVERFLOW_ROW_BIT(pj);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Consulta O(1) del mapa de overflow persistente de la dificultad actual.
+ * @return Mapa con un bit a 1 por cada pivot que genera overflow.
+ */
+const OverflowMap* matrix_getOverflowMap(){
+    return &overflowMaps[gameData.mode];
+}
+
+/**
+ * @brief Consulta O(1) de si el bloque del pivot (i, j) genera overflow, sin tocar @var pivot.
+ * @param i fila del pivot.
+ * @param j columna del pivot.
+ * @return TRUE si genera overflow, FALSE en caso contrario.
+ */
+bool matrix_isOverflowPivot(uint8 i, uint8 j){
+    return (overflowMaps[gameData.mode].rows[i] & OVERFLOW_ROW_BIT(j)) != 0;
+}
+
+/**
+ * @brief Número de pivots con overflow de un mapa.
+ * @param map Mapa de overflow.
+ * @param size Número de filas/columnas de la matriz del mapa.
+ * @return Número de bits a 1.
+ */
+uint16 matrix_countOverflows(const OverflowMap* map, uint8 size){
+    uint16 count = 0;
+
+    for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(size); i++)
+        count += __builtin_popcount(map->rows[i]);
+
+    return count;
+}
+
+/**
+ * @brief Pista: pivot con overflow (dificultad actual) al que se llega con menos movimientos desde
+ * (fromI, fromJ). Cada Iñatrix se mueve por su eje de uno en uno (@fn movementMgr_movePosition),
+ * así que el coste es la suma de las distancias de cada eje (@fn matrix_getMoveCost).
+ *
+ * Al ser separable, no hace falta recorrer los pivots: las filas se visitan por orden de distancia
+ * vertical (fromI, fromI ± 1, ...), en cada una el pivot más cercano se obtiene con dos búsquedas
+ * de bit sobre su máscara del mapa (@fn matrix_getNearestInRow), y se para en cuanto la distancia
+ * vertical ya no puede mejorar el mejor coste encontrado. Con cualquier densidad razonable de
+ * overflows bastan unas pocas filas; el peor caso está acotado por @def MATRIX_MAX_SIZE filas.
+ * Un punto de partida fuera del rango de pivots se lleva primero al pivot más cercano: todo camino
+ * hasta un pivot pasa por él, así que basta con sumar esa distancia.
+ * No toca @var pivot, así que se puede usar desde cualquier contexto.
+ * @param fromI fila de partida.
+ * @param fromJ columna de partida.
+ * @param nearest Pivot encontrado (sin modificar si no hay ninguno).
+ * @return Número de movimientos hasta él, o @def HINT_NONE si no hay ningún pivot con overflow.
+ */
+uint8 matrix_findNearestOverflow(uint8 fromI, uint8 fromJ, MatrixPivot* nearest){
+    const OverflowMap* map = &overflowMaps[gameData.mode];
+    uint8 best = HINT_NONE;
+    uint8 bestI = 0, bestJ = 0, j, cost;
+    uint8 startI = fromI, startJ = fromJ, offset;
+
+    if(startI < MATRIX_FIRST_PIVOT_I)
+        startI = MATRIX_FIRST_PIVOT_I;
+    else if(startI > MATRIX_LAST_PIVOT_I(matrixSize))
+        startI = MATRIX_LAST_PIVOT_I(matrixSize);
+    if(startJ < MATRIX_FIRST_PIVOT_J)
+        startJ = MATRIX_FIRST_PIVOT_J;
+    else if(startJ > MATRIX_LAST_PIVOT_J(matrixSize))
+        startJ = MATRIX_LAST_PIVOT_J(matrixSize);
+    offset = matrix_getMoveCost(fromI, fromJ, startI, startJ);
+
+    for(int d = 0; d < best; d++){
+        bool inside = false;
+
+        for(int side = -1; side <= 1; side += 2){
+            int i = startI + side * d;
+
+            if((i < MATRIX_FIRST_PIVOT_I) || (i > MATRIX_LAST_PIVOT_I(matrixSize)))
+                continue;
+            inside = true;
+            if(!map->rows[i])
+                continue;
+
+            cost = d + matrix_getNearestInRow(map->rows[i], startJ, &j);
+            if(cost < best){
+                best = cost;
+                bestI = i;
+                bestJ = j;
+            }
+            if(d == 0)
+                break;
+        }
+
+        if(!inside)
+            break;
+    }
+
+    if(best == HINT_NONE)
+        return HINT_NONE;
+
+    nearest->i = bestI;
+    nearest->j = bestJ;
+
+    return best + offset;
+}
+
+/**
+ * @brief Pivot con overflow más cercano a la columna j dentro de una fila del mapa: el primero a su
+ * derecha (bits bajos a partir de j, ctz) o el primero a su izquierda (bits altos hasta j, clz).
+ * @param row Máscara de la fila, no vacía (ver @def OVERFLOW_ROW_BIT).
+ * @param j columna de partida.
+ * @param nearestJ Columna encontrada.
+ * @return Distancia en columnas.
+ */
+uint8 matrix_getNearestInRow(OverflowRow row, uint8 j, uint8* nearestJ){
+    uint8 k = j - MATRIX_FIRST_PIVOT_J;
+    OverflowRow right = row >> k;
+    OverflowRow left = row << (31 - k);
+    uint8 dRight = right ? __builtin_ctz(right) : HINT_NONE;
+    uint8 dLeft = left ? __builtin_clz(left) : HINT_NONE;
+
+    *nearestJ = dRight <= dLeft ? j + dRight : j - dLeft;
+    return dRight <= dLeft ? dRight : dLeft;
+}
+
+/**
+ * @brief Número de movimientos de los Iñatrix para llevar el pivot de (fromI, fromJ) a (toI, toJ).
+ * @return Suma de las distancias de ambos ejes.
+ */
+uint8 matrix_getMoveCost(uint8 fromI, uint8 fromJ, uint8 toI, uint8 toJ){
+    return (fromI > toI ? fromI - toI : toI - fromI) + (fromJ > toJ ? fromJ - toJ : toJ - fromJ);
+}
+
+/**
+ * @brief Empaqueta en carriles de 8 bits el valor de la ventana de @def BITBLOCK_COLS bits de hasta
+ * 8 columnas de pivot consecutivas, a partir de la columna first.
+ * @param row Fila del bitboard.
+ * @param size Número de columnas del bitboard.
+ * @param first Primera columna de pivot del grupo.
+ * @return Carril (j - first) con el valor de la ventana del pivot de la columna j; a 0 si j no es pivot.
+ */
+uint64 matrix_getRowWindows(BitboardRow row, uint8 size, uint8 first){
+    uint64 windows = 0;
+    uint8 last = first + SWAR_LANES - 1 < MATRIX_LAST_PIVOT_J(size) ? first + SWAR_LANES - 1
+                                                                     : MATRIX_LAST_PIVOT_J(size);
+
+    for(int j = first; j <= last; j++)
+        windows |= (uint64) ((row >> BITBLOCK_SHIFT(size, j)) & BITBLOCK_MASK) << ((j - first) * SWAR_LANE_BITS);
+
+    return windows;
+}
+
+/**
+ * @brief Reúne el bit alto de cada carril en un byte (carril k -> bit k) con una multiplicación.
+ * @param lanes Palabra con los 8 carriles.
+ * @return Byte con un veredicto por carril.
+ */
+uint8 matrix_gatherLaneVerdicts(uint64 lanes){
+    return (((lanes & SWAR_LANES_HIGH) >> (SWAR_LANE_BITS - 1)) * SWAR_LANES_GATHER) >> 56;
 }
 
 /*
@@ -380,11 +1147,154 @@ bool matrix_evalBitBlockOverflow(){
 */
 
 /**
- * @brief En base al modo de juego (normal/dificil) se obtiene el número límite.
+ * @brief En base al modo de juego (normal/dificil), a la regla y a la forma en uso se obtiene el número límite.
  * @return Número que hará de límite a la hora de evaluar si se ha producido overflow o no.
  */
 uint8 matrix_getOverflowLimit(){
-    return gameData.mode == DIFFICULTY_NORMAL_MODE ? OVERFLOW_NM : OVERFLOW_HM;
+    return overflowRuleLimits[gameData.rule][gameData.shape][gameData.mode];
+}
+
+/**
+ * @brief Carga en un bitboard una matriz base (cuadrada) de @typedef Binary.
+ * @param base Dirección de memoria del primer elemento de la matriz bidimensional.
+ * @param rows Bitboard destino.
+ * @param size Número de filas/columnas.
+ */
+void matrix_loadBitboard(Binary *base, BitboardRow *rows, uint8 size){
+    matrix_loadTiledBitboard(base, size, rows, size, size);
+}
+
+/**
+ * @brief Carga en un bitboard una matriz base (cuadrada) de @typedef Binary, repitiéndola en
+ * mosaico si el bitboard tiene otras dimensiones; así la densidad de unos es la misma que la de la base.
+ * @param base Dirección de memoria del primer elemento de la matriz bidimensional.
+ * @param baseSize Número de filas/columnas de la matriz base.
+ * @param rows Bitboard destino.
+ * @param height Número de filas del bitboard.
+ * @param width Número de columnas del bitboard.
+ */
+void matrix_loadTiledBitboard(Binary *base, uint8 baseSize, BitboardRow *rows, uint8 height, uint8 width){
+    for(int i = 0; i < height; i++){
+        rows[i] = 0;
+        for(int j = 0; j < width; j++)
+            BITBOARD_SET(rows[i], width, j, *(base + (i % baseSize)*baseSize + (j % baseSize)));
+    }
+}
+
+/**
+ * @brief Obtiene el bit de la celda (i, j) de la matriz principal.
+ * @param i fila.
+ * @param j columna.
+ * @return Valor del dígito binario.
+ */
+Binary matrix_getBit(uint8 i, uint8 j){
+    return BITBOARD_GET(matrix[i], matrixSize, j);
+}
+
+/**
+ * @brief Establece el bit de la celda (i, j) de la matriz principal.
+ * @param i fila.
+ * @param j columna.
+ * @param bit Valor del dígito binario.
+ */
+void matrix_setBit(uint8 i, uint8 j, Binary bit){
+    BITBOARD_SET(matrix[i], matrixSize, j, bit);
+    matrix_refreshRowWindows(i, 1);
+    if((i >= viewport.i) && (i < viewport.i + MATRIX_VIEW_SIZE)
+    && (j >= viewport.j) && (j < viewport.j + MATRIX_VIEW_SIZE))
+        matrix_markViewDirty(i - viewport.i, BIT(j - viewport.j));
+}
+
+/**
+ * @brief Pinta el sprite de una celda con el dígito que le corresponde, en su posición.
+ * @param sprite Índice OAM del sprite asociado a la celda.
+ * @param bit Valor del dígito binario de la celda.
+ * @param i fila en pantalla (relativa al viewport en el caso de la matriz).
+ * @param j columna en pantalla (relativa al viewport en el caso de la matriz).
+ * @param hide Indica si el sprite ha de ocultarse.
+ */
+void matrix_displayCell(uint8 sprite, Binary bit, uint8 i, uint8 j, bool hide){
+    sprites_setSpriteGfx(sprite, gfxInfo_getDigitGfx(bit), matrix_getPositionX(j), matrix_getPositionY(i), hide);
+    oamUpdate(&oamMain);
+}
+
+/**
+ * @brief Deja el sprite de una celda del viewport con el dígito, posición y visibilidad que le
+ * corresponden, pero solo lo toca si algo de eso ha cambiado. No vuelca la OAM (ver
+ * @fn sprites_setSpriteGfx). El sprite ha de haberse pintado antes al menos una vez (ver
+ * @fn matrix_initSystem).
+ * @param bit Valor del dígito binario de la celda.
+ * @param i fila en pantalla.
+ * @param j columna en pantalla.
+ * @param offsetY píxeles por encima de su posición a los que se ha de pintar (p.ej. mientras cae).
+ * @param hide Indica si el sprite ha de ocultarse.
+ * @return TRUE si se ha tenido que actualizar el sprite, FALSE en caso contrario.
+ */
+bool matrix_syncCell(Binary bit, uint8 i, uint8 j, uint8 offsetY, bool hide){
+    SpriteEntry* entry = sprites_getSpriteEntryByIndex(matrixSprites[i][j]);
+    uint8 y = matrix_getPositionY(i) - offsetY; // Por encima de la pantalla da la vuelta, como en la OAM.
+
+    if((matrixDigits[i][j] == bit) && (entry->x == matrix_getPositionX(j))
+    && (entry->y == y) && (entry->isHidden == hide))
+        return false;
+
+    matrixDigits[i][j] = bit;
+    sprites_setSpriteGfx(matrixSprites[i][j], gfxInfo_getDigitGfx(bit), matrix_getPositionX(j), y, hide);
+    return true;
+}
+
+/**
+ * @brief Marca celdas de una fila del viewport como pendientes de pintar.
+ * @param row fila en pantalla.
+ * @param cols máscara de columnas en pantalla (se descartan las que quedan fuera del viewport).
+ */
+void matrix_markViewDirty(uint8 row, ViewMask cols){
+    viewDirty[row] |= cols & VIEW_MASK_ALL;
+    matrixGeneration++;
+}
+
+/**
+ * @brief Marca como pendientes las celdas del viewport que caen en las filas [first, first + count)
+ * de la matriz (p.ej. tras modificar esas filas del bitboard).
+ * @param first Primera fila de la matriz.
+ * @param count Número de filas.
+ */
+void matrix_markRowsDirty(uint8 first, uint8 count){
+    int from = first > viewport.i ? first - viewport.i : 0;
+    int to = first + count < viewport.i + MATRIX_VIEW_SIZE ? first + count - viewport.i : MATRIX_VIEW_SIZE;
+
+    for(int i = from; i < to; i++)
+        matrix_markViewDirty(i, VIEW_MASK_ALL);
+}
+
+/**
+ * @brief Pinta el frame: recorre únicamente las celdas pendientes y actualiza los sprites cuyo estado
+ * ha cambiado de verdad, sin volcar la OAM (se vuelca una vez por frame, en eventMgr_UpdatePhases).
+ * Si no ha cambiado nada desde el último frame pintado no recorre nada.
+ * @return Número de sprites actualizados.
+ */
+uint8 matrix_commitView(){
+    uint8 updated = 0;
+
+    if(committedGeneration == matrixGeneration)
+        return 0;
+
+    for(int i = 0; i < MATRIX_VIEW_SIZE; i++){
+        ViewMask dirty = viewDirty[i];
+
+        viewDirty[i] = 0;
+        while(dirty){
+            uint8 j = __builtin_ctz(dirty);
+
+            dirty &= dirty - 1;
+            updated += matrix_syncCell(matrix_getBit(viewport.i + i, viewport.j + j), i, j,
+                                       viewport.i + i <= collapseLastRows[j] ? collapseOffset[j] : 0,
+                                       isMatrixHidden || (i >= revealRow));
+        }
+    }
+
+    committedGeneration = matrixGeneration;
+    return updated;
 }
 
 /**
@@ -403,4 +1313,80 @@ uint8 matrix_getPositionX(uint8 axis){
  */
 uint8 matrix_getPositionY(uint8 axis){
     return  MATRIX_Y_POS + (axis * MATRIX_Y_PADDING);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Número de filas/columnas de la matriz en esta sesión.
+ * @return @var matrixSize
+ */
+uint8 matrix_getSize(){
+    return matrixSize;
+}
+
+/**
+ * @brief Desplaza el viewport lo mínimo necesario para que el bloque del pivot (i, j) quede
+ * dentro de la pantalla y, si se desplaza, marca el viewport para volver a pintarlo (solo se
+ * tocarán los sprites cuyo dígito cambie).
+ * @param i fila del pivot.
+ * @param j columna del pivot.
+ * @return TRUE si el viewport se ha desplazado, FALSE en caso contrario.
+ */
+bool matrix_scrollViewport(uint8 i, uint8 j){
+    uint8 offsetI = matrix_getViewportOffset(i, viewport.i, BITBLOCK_TOP, BITBLOCK_BOTTOM);
+    uint8 offsetJ = matrix_getViewportOffset(j, viewport.j, BITBLOCK_LEFT, BITBLOCK_RIGHT);
+
+    if((offsetI == viewport.i) && (offsetJ == viewport.j))
+        return false;
+
+    viewport.i = offsetI;
+    viewport.j = offsetJ;
+    matrix_markRowsDirty(viewport.i, MATRIX_VIEW_SIZE);
+
+    return true;
+}
+
+/**
+ * @brief Calcula, para un eje, el desplazamiento del viewport que deja la posición dada a al
+ * menos before/after celdas de cada borde (lo que ocupa el bloque a cada lado del pivot),
+ * moviéndolo lo mínimo posible.
+ * @param pos fila/columna en la matriz.
+ * @param offset desplazamiento actual del viewport en ese eje.
+ * @param before celdas del bloque antes del pivot en ese eje.
+ * @param after celdas del bloque después del pivot en ese eje.
+ * @return Nuevo desplazamiento.
+ */
+uint8 matrix_getViewportOffset(uint8 pos, uint8 offset, uint8 before, uint8 after){
+    if(pos < offset + before)
+        offset = pos - before;
+    else if(pos + after >= offset + MATRIX_VIEW_SIZE)
+        offset = pos + after + 1 - MATRIX_VIEW_SIZE;
+
+    return offset < matrixSize - MATRIX_VIEW_SIZE ? offset : matrixSize - MATRIX_VIEW_SIZE;
+}
+
+/**
+ * @brief Obtiene la entrada OAM del sprite del viewport bajo el que se muestra la celda (i, j) de
+ * la matriz. La celda ha de estar dentro del viewport (el bloque del pivot siempre lo está).
+ * @param i fila en la matriz.
+ * @param j columna en la matriz.
+ * @return Puntero al SpriteEntry de la celda.
+ */
+SpriteEntry* matrix_getCellEntry(uint8 i, uint8 j){
+    return sprites_getSpriteEntryByIndex(matrixSprites[i - viewport.i][j - viewport.j]);
+}
+
+/**
+ * @brief Última fila en la que puede estar el pivot (el bloque ha de caber en la matriz).
+ * @return Fila.
+ */
+uint8 matrix_getLastPivotRow(){
+    return MATRIX_LAST_PIVOT_I(matrixSize);
+}
+
+/**
+ * @brief Última columna en la que puede estar el pivot (el bloque ha de caber en la matriz).
+ * @return Columna.
+ */
+uint8 matrix_getLastPivotColumn(){
+    return MATRIX_LAST_PIVOT_J(matrixSize);
+}
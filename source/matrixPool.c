@@ -0,0 +1,435 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file matrixPool.c
+ * @brief Pool (ring) de matrices pre-generadas. El loop principal, que está ocioso la mayor
+ * parte del tiempo, lo mantiene lleno; la regeneración de la matriz (en la cadena de la
+ * interrupción del timer) se limita a copiar una entrada, con un coste acotado.
+ *
+ * Las matrices se generan con una densidad de overflows acotada por dificultad (@var overflowBands),
+ * para que ninguna partida quede decidida por una matriz casi sin overflows o saturada de ellos.
+ *
+ * Con la misma disciplina se mantiene un segundo ring, de bloques de bits de reemplazo ya
+ * permutados (@var bitBlockRing), del que se sirve cada regeneración del bloque de bits.
+ *
+ * Un único productor (loop principal) y un único consumidor (interrupción): el productor
+ * solo escribe @var matrixPoolTail y el consumidor solo escribe @var matrixPoolHead, por lo
+ * que no hace falta deshabilitar interrupciones, siempre que cada contador se avance después de
+ * escribir (o leer) la entrada, ver @def MATRIX_POOL_BARRIER. Del mismo modo, cada contador de
+ * @var matrixPoolStats lo escribe un único lado. La excepción es @fn matrixPool_reset, que descarta
+ * lo pendiente desde el loop principal y por eso deshabilita las interrupciones.
+ */
+
+#include "matrixPool.h"
+#include "timer.h"
+#include "game.h"
+
+/**
+ * @var matrixPool[MATRIX_POOL_SIZE]: Entradas del ring.
+ * @var matrixPoolHead: Contador de entradas consumidas (lo avanza la interrupción).
+ * @var matrixPoolTail: Contador de entradas generadas (lo avanza el loop principal).
+ * @var matrixPoolRng: Generador propio, para no compartir estado con la interrupción.
+ * @var matrixPoolBase/matrixPoolBaseBuffer: Bitboards de las matrices base, que son las que se permutan.
+ * @var matrixPoolConsumeTicks: Instante (ticks) de la última extracción pendiente de reponer.
+ * @var matrixPoolMissEntry: Entrada que se genera en el momento si el pool está vacío (fuera de la
+ * pila, ya que puede ocurrir dentro de la interrupción).
+ */
+MatrixPoolEntry matrixPool[MATRIX_POOL_SIZE];
+volatile uint8 matrixPoolHead;
+volatile uint8 matrixPoolTail;
+RngState matrixPoolRng;
+BitboardRow matrixPoolBase[MATRIX_MAX_SIZE];
+BitboardRow matrixPoolBaseBuffer[BITBLOCK_ROWS];
+volatile int matrixPoolConsumeTicks;
+MatrixPoolEntry matrixPoolMissEntry;
+MatrixPoolStats matrixPoolStats;
+
+/**
+ * @var bitBlockRing[BITBLOCK_RING_SIZE]: Bloques de bits de reemplazo.
+ * @var bitBlockRingHead: Contador de bloques consumidos (lo avanza la interrupción).
+ * @var bitBlockRingTail: Contador de bloques generados (lo avanza el loop principal).
+ * @var bitBlockRingRng: Generador propio del ring; así la secuencia de bloques no depende de cómo
+ * se intercalen las reposiciones de ambos rings, y la sesión sigue siendo reproducible.
+ */
+BitBlockRingEntry bitBlockRing[BITBLOCK_RING_SIZE];
+volatile uint8 bitBlockRingHead;
+volatile uint8 bitBlockRingTail;
+RngState bitBlockRingRng;
+
+/**
+ * @var overflowBands[OVERFLOW_MAPS]: Bandas de densidad admitidas, indexadas por @enum Difficulty.
+ */
+OverflowBand overflowBands[OVERFLOW_MAPS] = {
+    { OVERFLOW_BAND_NM_MIN, OVERFLOW_BAND_NM_MAX },
+    { OVERFLOW_BAND_HM_MIN, OVERFLOW_BAND_HM_MAX }
+};
+
+/**
+ * @var overflowRuleBands[OVERFLOW_RULES][BITBLOCK_SHAPES][OVERFLOW_MAPS]: Bandas por defecto de cada
+ * regla de overflow (@enum OverflowRule) y forma de selección (@enum BitBlockShape), por cada
+ * @def OVERFLOW_BAND_PIVOTS pivots. Cada combinación tiene su propia distribución de overflows, así
+ * que todas se sacan igual: de 50000 permutaciones de la matriz base de 10x10, el mínimo descarta
+ * como mucho el 10% más disperso (las partidas injustas) y el máximo deja dentro al menos el 99%.
+ * Las genera tests/host/densityTool, que falla si esta tabla no coincide con lo que calcula; si
+ * cambia la matriz base, el bloque o una regla, se sustituye por la tabla que imprime.
+ * Con @enum OVERFLOW_RULE_DIAGONALS y cualquier forma salvo el bloque entero ambas dificultades
+ * tienen la misma banda: las diagonales de esas formas solo valen 0, 1, 4 o 5, y ninguno de esos
+ * valores cae entre los dos límites, así que dan los mismos veredictos.
+ */
+const OverflowBand overflowRuleBands[OVERFLOW_RULES][BITBLOCK_SHAPES][OVERFLOW_MAPS] = {
+    [OVERFLOW_RULE_ROWS] = {
+        [BITBLOCK_SHAPE_SQUARE] = { { OVERFLOW_BAND_NM_MIN, OVERFLOW_BAND_NM_MAX }, { OVERFLOW_BAND_HM_MIN, OVERFLOW_BAND_HM_MAX } },
+        [BITBLOCK_SHAPE_PLUS] = { { 43, 55 }, { 17, 30 } },
+        [BITBLOCK_SHAPE_L] = { { 34, 47 }, { 8, 19 } },
+        [BITBLOCK_SHAPE_LINE] = { { 33, 42 }, { 17, 28 } },
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = { { 42, 55 }, { 13, 24 } }
+    },
+    [OVERFLOW_RULE_COLUMNS] = {
+        [BITBLOCK_SHAPE_SQUARE] = { { 42, 56 }, { 7, 21 } },
+        [BITBLOCK_SHAPE_PLUS] = { { 43, 55 }, { 17, 30 } },
+        [BITBLOCK_SHAPE_L] = { { 38, 49 }, { 22, 33 } },
+        [BITBLOCK_SHAPE_LINE] = { { 34, 47 }, { 8, 19 } },
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = { { 42, 55 }, { 13, 24 } }
+    },
+    [OVERFLOW_RULE_DIAGONALS] = {
+        [BITBLOCK_SHAPE_SQUARE] = { { 35, 46 }, { 8, 18 } },
+        [BITBLOCK_SHAPE_PLUS] = { { 33, 42 }, { 33, 42 } },
+        [BITBLOCK_SHAPE_L] = { { 33, 42 }, { 33, 42 } },
+        [BITBLOCK_SHAPE_LINE] = { { 33, 42 }, { 33, 42 } },
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = { { 33, 42 }, { 33, 42 } }
+    },
+    [OVERFLOW_RULE_SIGNED_ROWS] = {
+        [BITBLOCK_SHAPE_SQUARE] = { { 3, 13 }, { 0, 5 } },
+        [BITBLOCK_SHAPE_PLUS] = { { 14, 23 }, { 3, 10 } },
+        [BITBLOCK_SHAPE_L] = { { 34, 47 }, { 8, 19 } },
+        [BITBLOCK_SHAPE_LINE] = { { 13, 21 }, { 7, 13 } },
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = { { 42, 55 }, { 13, 24 } }
+    },
+    [OVERFLOW_RULE_ANY_ROW] = {
+        [BITBLOCK_SHAPE_SQUARE] = { { 56, 64 }, { 38, 55 } },
+        [BITBLOCK_SHAPE_PLUS] = { { 57, 63 }, { 53, 62 } },
+        [BITBLOCK_SHAPE_L] = { { 56, 64 }, { 53, 62 } },
+        [BITBLOCK_SHAPE_LINE] = { { 33, 42 }, { 17, 28 } },
+        [BITBLOCK_SHAPE_SMALL_SQUARE] = { { 49, 58 }, { 29, 45 } }
+    }
+};
+
+/**
+ * @brief Inicializa el pool y lo llena por completo (en el arranque no hay prisa).
+ * Ha de invocarse después de @fn rng_initSystem para que la sesión sea reproducible, y después
+ * de @fn matrix_initSystem, ya que las entradas tienen el tamaño de matriz de la sesión.
+ */
+void matrixPool_init(){
+    RngState seed, bitBlockSeed;
+
+    rng_seed(&seed, rng_next(&gameRng));
+    rng_seed(&bitBlockSeed, rng_next(&gameRng));
+    matrixPoolHead = matrixPoolTail = 0;
+    bitBlockRingHead = bitBlockRingTail = 0;
+    matrixPoolStats.minDepth = MATRIX_POOL_SIZE;
+    matrixPool_reset(seed, bitBlockSeed);
+
+    while(matrixPool_refill());
+}
+
+/**
+ * @brief Vacía el pool y el ring de bloques y los prepara para el tamaño de matriz actual, de
+ * manera que las siguientes entradas se generen a partir de los estados dados. No genera nada (lo
+ * hará el loop principal), así que su coste es constante. Se usa al restaurar un snapshot (ver
+ * matrixSnapshot.c) y al cambiar de regla o de forma (@fn game_resetMatrixPool), y ha de invocarse
+ * desde el loop principal, nunca con una regeneración en curso.
+ * Para descartar lo pendiente, el productor escribe aquí también los contadores del consumidor
+ * (@var matrixPoolHead y @var bitBlockRingHead), así que lo hace con las interrupciones
+ * deshabilitadas: la interrupción no puede estar sirviendo una entrada a la vez.
+ * @param seed Estado del generador del pool, p.ej. el de @fn matrixPool_getNextSeed.
+ * @param bitBlockSeed Estado del generador del ring, p.ej. el de @fn matrixPool_getNextBitBlockSeed.
+ */
+void matrixPool_reset(RngState seed, RngState bitBlockSeed){
+    uint32 ime = IME;
+
+    matrixPoolRng = seed;
+    bitBlockRingRng = bitBlockSeed;
+    matrix_loadTiledBitboard(baseMatrix[0], MATRIX_BASE_SIZE, matrixPoolBase, matrixSize, matrixSize);
+    matrixPool_scaleOverflowBands(matrixSize);
+    matrix_loadTiledBitboard(baseBitBlockBuffer[0], BITBLOCK_BASE_SIZE, matrixPoolBaseBuffer,
+                             BITBLOCK_ROWS, BITBLOCK_COLS);
+
+    IME = 0;
+    matrixPoolHead = matrixPoolTail;
+    bitBlockRingHead = bitBlockRingTail;
+    matrixPoolConsumeTicks = -1;
+    IME = ime;
+}
+
+/**
+ * @brief Estado del generador del pool a partir del cual se genera la siguiente matriz que se
+ * servirá: el de la primera entrada pendiente o, si el pool está vacío, el actual.
+ * @return Estado del generador.
+ */
+RngState matrixPool_getNextSeed(){
+    if(matrixPool_getDepth() == 0)
+        return matrixPoolRng;
+
+    return matrixPool[MATRIX_POOL_INDEX(matrixPoolHead)].seed;
+}
+
+/**
+ * @brief Genera una matriz nueva si hay hueco en el pool, y un bloque de bits nuevo si hay hueco en
+ * el ring. Pensada para el loop principal: como mucho genera una entrada de cada por llamada, así
+ * el loop nunca se bloquea.
+ * @return TRUE si se ha generado algo, FALSE si ambos estaban llenos.
+ */
+bool matrixPool_refill(){
+    bool bitBlock = matrixPool_refillBitBlock();
+    uint8 rejected;
+
+    if(matrixPool_getDepth() == MATRIX_POOL_SIZE)
+        return bitBlock;
+
+    rejected = matrixPool_generateEntry(&matrixPoolRng, &matrixPool[MATRIX_POOL_INDEX(matrixPoolTail)],
+                                        MATRIX_POOL_MAX_ATTEMPTS);
+    MATRIX_POOL_BARRIER();
+    matrixPoolTail++;
+    matrixPoolStats.rejected += rejected;
+    if(rejected == MATRIX_POOL_MAX_ATTEMPTS)
+        matrixPoolStats.outOfBand++;
+    matrixPoolStats.generated++;
+
+    if(matrixPoolConsumeTicks >= 0){
+        matrixPoolStats.lastRefillTicks = timer.totalTicks - matrixPoolConsumeTicks;
+        if(matrixPoolStats.lastRefillTicks > matrixPoolStats.maxRefillTicks)
+            matrixPoolStats.maxRefillTicks = matrixPoolStats.lastRefillTicks;
+        matrixPoolConsumeTicks = -1;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Sustituye la matriz principal, el buffer y los mapas de overflow por la siguiente
+ * entrada del pool. Coste acotado: únicamente copias de unos cientos de bytes como mucho.
+ * Si el pool está vacío la entrada se genera en el momento, con @var gameRng ya que estamos en el
+ * contexto del consumidor, y con un único intento: dentro de la interrupción cuesta una permutación
+ * y un cálculo de mapas (lo mismo que una regeneración sin pool), aunque quede fuera de banda.
+ * @return TRUE si se ha servido desde el pool, FALSE si estaba vacío (se contabiliza como fallo).
+ */
+bool matrixPool_consume(){
+    uint8 depth = matrixPool_getDepth();
+    MatrixPoolEntry* entry;
+
+    if(depth == 0){
+        matrixPoolStats.misses++;
+        if(matrixPool_generateEntry(&gameRng, &matrixPoolMissEntry, 1))
+            matrixPoolStats.missesOutOfBand++;
+        entry = &matrixPoolMissEntry;
+    }
+    else
+    {
+        if(depth < matrixPoolStats.minDepth)
+            matrixPoolStats.minDepth = depth;
+        entry = &matrixPool[MATRIX_POOL_INDEX(matrixPoolHead)];
+    }
+
+    for(int i = 0; i < matrixSize; i++)
+        matrix[i] = entry->matrix[i];
+    for(int i = 0; i < BITBLOCK_ROWS; i++)
+        bitBlockBuffer[i] = entry->bitBlockBuffer[i];
+    if(entry->rule == gameData.rule && entry->shape == gameData.shape){
+        for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+            overflowMaps[mode] = entry->overflowMaps[mode];
+    }
+    else
+        matrix_rebuildOverflowMaps(); // Generada antes de cambiar de regla o de forma.
+
+    if(depth == 0)
+        return false;
+
+    MATRIX_POOL_BARRIER();
+    matrixPoolHead++;
+    matrixPoolStats.consumed++;
+    if(matrixPoolConsumeTicks < 0)
+        matrixPoolConsumeTicks = timer.totalTicks;
+
+    return true;
+}
+
+/**
+ * @brief Genera un bloque de bits nuevo si hay hueco en el ring.
+ * @return TRUE si se ha generado, FALSE si el ring estaba lleno.
+ */
+bool matrixPool_refillBitBlock(){
+    BitBlockRingEntry* entry;
+
+    if(matrixPool_getBitBlockDepth() == BITBLOCK_RING_SIZE)
+        return false;
+
+    entry = &bitBlockRing[BITBLOCK_RING_INDEX(bitBlockRingTail)];
+    entry->seed = bitBlockRingRng;
+    matrixPool_generateBitBlock(&bitBlockRingRng, entry->rows);
+    MATRIX_POOL_BARRIER();
+    bitBlockRingTail++;
+    matrixPoolStats.bitBlocksGenerated++;
+
+    return true;
+}
+
+/**
+ * @brief Sirve el siguiente bloque de bits de reemplazo: copia de @def BITBLOCK_ROWS filas, O(1).
+ * Si el ring está vacío se genera en el momento con @var gameRng (contexto del consumidor).
+ * @param rows Bitboard destino, p.ej. @var bitBlockBuffer.
+ * @return TRUE si se ha servido desde el ring, FALSE si estaba vacío (se contabiliza como fallo).
+ */
+bool matrixPool_consumeBitBlock(BitboardRow* rows){
+    const BitBlockRingEntry* entry;
+
+    if(matrixPool_getBitBlockDepth() == 0){
+        matrixPoolStats.bitBlockMisses++;
+        matrixPool_generateBitBlock(&gameRng, rows);
+        return false;
+    }
+
+    entry = &bitBlockRing[BITBLOCK_RING_INDEX(bitBlockRingHead)];
+    for(int i = 0; i < BITBLOCK_ROWS; i++)
+        rows[i] = entry->rows[i];
+
+    MATRIX_POOL_BARRIER();
+    bitBlockRingHead++;
+    matrixPoolStats.bitBlocksConsumed++;
+    return true;
+}
+
+/**
+ * @brief Número de bloques de bits listos para ser servidos.
+ * @return Profundidad actual del ring.
+ */
+uint8 matrixPool_getBitBlockDepth(){
+    return (uint8) (bitBlockRingTail - bitBlockRingHead);
+}
+
+/**
+ * @brief Estado del generador del ring a partir del cual se genera el siguiente bloque que se
+ * servirá, ver @fn matrixPool_getNextSeed.
+ * @return Estado del generador.
+ */
+RngState matrixPool_getNextBitBlockSeed(){
+    if(matrixPool_getBitBlockDepth() == 0)
+        return bitBlockRingRng;
+
+    return bitBlockRing[BITBLOCK_RING_INDEX(bitBlockRingHead)].seed;
+}
+
+/**
+ * @brief Genera un bloque de bits: permutación uniforme del buffer base.
+ * @param rng Generador a utilizar (cada contexto usa el suyo).
+ * @param rows Bitboard destino.
+ */
+void matrixPool_generateBitBlock(RngState* rng, BitboardRow* rows){
+    for(int i = 0; i < BITBLOCK_ROWS; i++)
+        rows[i] = matrixPoolBaseBuffer[i];
+
+    matrix_shuffleBitboard(rng, rows, BITBLOCK_ROWS, BITBLOCK_COLS);
+}
+
+/**
+ * @brief Número de entradas listas para ser servidas.
+ * @return Profundidad actual del pool.
+ */
+uint8 matrixPool_getDepth(){
+    return (uint8) (matrixPoolTail - matrixPoolHead);
+}
+
+/**
+ * @brief Genera una entrada: permutaciones uniformes de la matriz base y del buffer base,
+ * junto con sus mapas de overflow. Si la matriz queda fuera de las bandas de densidad se descarta
+ * y se vuelve a permutar (muestreo por rechazo), como mucho el número de intentos dado; el último
+ * se acepta aunque quede fuera. Gracias a la evaluación por bitboards cada intento cuesta muy poco.
+ * No toca @var matrixPoolStats: se llama desde ambos lados del pool y cada uno cuenta lo suyo.
+ * @param rng Generador a utilizar (cada contexto usa el suyo).
+ * @param entry Entrada destino.
+ * @param attempts Número máximo de intentos (al menos 1).
+ * @return Matrices descartadas; igual a attempts si la aceptada ha quedado fuera de banda.
+ */
+uint8 matrixPool_generateEntry(RngState* rng, MatrixPoolEntry* entry, uint8 attempts){
+    uint8 rejected = 0;
+
+    entry->seed = *rng;
+    entry->rule = gameData.rule;
+    entry->shape = gameData.shape;
+
+    while(rejected < attempts){
+        for(int i = 0; i < matrixSize; i++)
+            entry->matrix[i] = matrixPoolBase[i];
+
+        matrix_shuffleBitboard(rng, entry->matrix, matrixSize, matrixSize);
+        matrix_buildOverflowMaps(entry->matrix, matrixSize, entry->overflowMaps);
+
+        if(matrixPool_isInBand(entry->overflowMaps))
+            break;
+
+        rejected++;
+    }
+
+    matrixPool_generateBitBlock(rng, entry->bitBlockBuffer);
+
+    return rejected;
+}
+
+/**
+ * @brief Comprueba si los mapas de overflow de una matriz caen dentro de la banda de cada dificultad.
+ * @param maps Mapas de overflow, indexados por @enum Difficulty.
+ * @return TRUE si están todos dentro de su banda, FALSE en caso contrario.
+ */
+bool matrixPool_isInBand(const OverflowMap* maps){
+    for(int mode = 0; mode < OVERFLOW_MAPS; mode++){
+        uint16 count = matrix_countOverflows(&maps[mode], matrixSize);
+        if(count < overflowBands[mode].min || count > overflowBands[mode].max)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Configura la banda de densidad de una dificultad. Las entradas ya generadas no se
+ * descartan; la nueva banda aplica a partir de la siguiente generación.
+ * @param mode Dificultad, @enum Difficulty.
+ * @param min Mínimo de pivots con overflow (incluido).
+ * @param max Máximo de pivots con overflow (incluido).
+ */
+void matrixPool_setOverflowBand(uint8 mode, uint16 min, uint16 max){
+    overflowBands[mode].min = min;
+    overflowBands[mode].max = max;
+}
+
+/**
+ * @brief Escala las bandas de densidad por defecto de la regla y la forma en uso (definidas por cada
+ * @def OVERFLOW_BAND_PIVOTS pivots) al número de pivots de una matriz del tamaño dado.
+ * @param size Número de filas/columnas de la matriz.
+ */
+void matrixPool_scaleOverflowBands(uint8 size){
+    uint16 pivots = MATRIX_PIVOTS_I(size) * MATRIX_PIVOTS_J(size);
+    const OverflowBand* bands = overflowRuleBands[gameData.rule][gameData.shape];
+
+    for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+        matrixPool_setOverflowBand(mode, bands[mode].min * pivots / OVERFLOW_BAND_PIVOTS,
+                                   bands[mode].max * pivots / OVERFLOW_BAND_PIVOTS);
+}
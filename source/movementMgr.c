@@ -70,33 +70,42 @@ void movementMgr_updateDirection(MovementGfx movGfx, Direction direction){
  * @param direction dirección en la que el sprite se va a mover.
  * @param posId Asociación con la matriz. Hace referencia a la fila o columna asociada a
  * la posición del sprite en cada momento.
+ * @param lastPos Última fila o columna válida para el pivot en el eje del movimiento.
  * @return 1 si no se ha de cambiar la dirección y -1 en caso contrario.
  */
-int8 movementMgr_getMultiplier(Direction direction, uint8 posId){
+int8 movementMgr_getMultiplier(Direction direction, uint8 posId, uint8 lastPos){
     return (((posId == START_POS) && (direction == DIRECTION_BACKWARDS))
-    || ((posId == MATRIX_SIZE-START_POS-1) && (direction == DIRECTION_FORWARDS))) ? -1 : 1;
+    || ((posId == lastPos) && (direction == DIRECTION_FORWARDS))) ? -1 : 1;
 }
 
 /**
  * @brief Función encargada de gestionar el movimiento en bloque del personaje, manteniendo la asociación
  * con la posición del elemento pivote de la matriz en todo momento.
+ * Si la nueva posición queda en el borde del viewport, es la matriz la que se desplaza y el
+ * sprite se queda donde está (su destino es su propia posición).
  * @param movGfx tipo de movimiento asociado a Iñatrix.
  */
 void movementMgr_movePosition(MovementGfx movGfx){
     movementInfo[movGfx]->startPos.x = movementInfo[movGfx]->sprite->spriteEntry->x;
     movementInfo[movGfx]->startPos.y = movementInfo[movGfx]->sprite->spriteEntry->y;
-    int mul = movementMgr_getMultiplier(movementInfo[movGfx]->direction, movementInfo[movGfx]->posId);
+    int mul = movementMgr_getMultiplier(movementInfo[movGfx]->direction, movementInfo[movGfx]->posId,
+                                        movGfx == MOVEMENT_INATRIX_X ? matrix_getLastPivotColumn()
+                                                                     : matrix_getLastPivotRow());
+    uint8 nextPos = movementInfo[movGfx]->posId + (mul * movementInfo[movGfx]->direction);
+    bool scrolled;
     // @todo: Rehacer esto, chapuza.
     if(movGfx == MOVEMENT_INATRIX_X){
+        scrolled = matrix_scrollViewport(movementMgr_getPositionY(), nextPos);
         movementInfo[movGfx]->destinyPos.x =
                 movementInfo[movGfx]->startPos.x +
-                (MATRIX_X_PADDING * mul * movementInfo[movGfx]->direction);
+                (scrolled ? 0 : MATRIX_X_PADDING * mul * movementInfo[movGfx]->direction);
 
         movementInfo[movGfx]->destinyPos.y = movementInfo[movGfx]->startPos.y;
     } else {
+        scrolled = matrix_scrollViewport(nextPos, movementMgr_getPositionX());
         movementInfo[movGfx]->destinyPos.y =
                 movementInfo[movGfx]->startPos.y +
-                (MATRIX_Y_PADDING * mul * movementInfo[movGfx]->direction);
+                (scrolled ? 0 : MATRIX_Y_PADDING * mul * movementInfo[movGfx]->direction);
 
         movementInfo[movGfx]->destinyPos.x = movementInfo[movGfx]->startPos.x;
     }
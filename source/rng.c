@@ -0,0 +1,113 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file rng.c
+ * @brief Servicio de números pseudoaleatorios (xorshift32, Marsaglia 2003). Sustituye a
+ * srand()/rand(): cada llamada cuesta un número fijo y pequeño de instrucciones y, a partir
+ * de una única semilla, toda la sesión es reproducible.
+ */
+
+#include "rng.h"
+
+/**
+ * @var gameRng: Generador compartido por los sistemas del juego (matrices, etc). Arranca con
+ * una semilla por defecto válida, por si se usa antes de @fn rng_initSystem.
+ */
+RngState gameRng = { RNG_DEFAULT_SEED };
+
+/**
+ * @brief Inicializa el generador compartido. Se invoca una única vez por sesión.
+ * @param seed Semilla de la sesión.
+ */
+void rng_initSystem(uint32 seed){
+    rng_seed(&gameRng, seed);
+}
+
+/**
+ * @brief Siembra un generador. La semilla se mezcla (finalizador de murmur3) para que
+ * semillas parecidas (p.ej. segundos consecutivos del RTC) den secuencias distintas.
+ * @param rng Generador a sembrar.
+ * @param seed Semilla.
+ */
+void rng_seed(RngState* rng, uint32 seed){
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6B;
+    seed ^= seed >> 13;
+    seed *= 0xC2B2AE35;
+    seed ^= seed >> 16;
+
+    rng->state = seed ? seed : RNG_DEFAULT_SEED;
+}
+
+/**
+ * @brief Siguiente número de la secuencia.
+ * @param rng Generador.
+ * @return Número de 32 bits.
+ */
+uint32 rng_next(RngState* rng){
+    uint32 x = rng->state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return rng->state = x;
+}
+
+/**
+ * @brief Número en el rango [0, bound) sin sesgo, con el método de multiplicación de Lemire (2019).
+ * Solo se descarta (y se recurre a una división) en el raro caso de caer en la zona sesgada.
+ * @param rng Generador.
+ * @param bound Límite superior (excluido), mayor que 0.
+ * @return Número en [0, bound).
+ */
+uint32 rng_bounded(RngState* rng, uint32 bound){
+    uint64 m = (uint64) rng_next(rng) * bound;
+
+    if((uint32) m < bound){
+        uint32 threshold = -bound % bound;
+        while((uint32) m < threshold)
+            m = (uint64) rng_next(rng) * bound;
+    }
+
+    return m >> 32;
+}
+
+/**
+ * @brief Rellena un buffer con números de la secuencia: los mismos que size llamadas a
+ * @fn rng_next, pero con el estado en un registro durante todo el bucle.
+ * @param rng Generador.
+ * @param buffer Buffer destino.
+ * @param size Número de elementos.
+ */
+void rng_fill(RngState* rng, uint32* buffer, int size){
+    uint32 x = rng->state;
+
+    for(int k = 0; k < size; k++){
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buffer[k] = x;
+    }
+
+    rng->state = x;
+}
@@ -88,10 +88,21 @@ void sprites_setNextMemoryAddress(GfxData* gfx){
  * @param gfx
  */
 void sprites_createSprite(GfxData* gfx){
-    sprites[gfx->GUID] = malloc(sizeof(Sprite));
-    sprites[gfx->GUID]->index = gfx->GUID; // @todo: cambiar
-    sprites[gfx->GUID]->speed = DEFAULT_SPRITE_SPEED;
-    sprites[gfx->GUID]->gfx = gfx;
+    sprites_createSpriteView(gfx->GUID, gfx);
+}
+
+/**
+ * @brief Reserva memoria dinámica para un @struct Sprite en el índice dado, asociándolo
+ * a un GFX ya presente en el banco de memoria. Permite que varios sprites compartan GFX
+ * (p.ej. las celdas de la matriz con los dígitos).
+ * @param index índice del sprite (y de su entrada en oamMain).
+ * @param gfx
+ */
+void sprites_createSpriteView(uint8 index, GfxData* gfx){
+    sprites[index] = malloc(sizeof(Sprite));
+    sprites[index]->index = index;
+    sprites[index]->speed = DEFAULT_SPRITE_SPEED;
+    sprites[index]->gfx = gfx;
 }
 
 /**
@@ -162,23 +173,48 @@ void sprites_setMainPalette() {
  * @param isHidden
  */
 void sprites_displaySprite(uint8 index, int x, int y, bool isHidden){
+    sprites_setSprite(index, x, y, isHidden);
+    oamUpdate(&oamMain);
+}
+
+/**
+ * @brief Igual que @fn sprites_displaySprite, pero sin volcar la OAM: el cambio queda en la copia
+ * de oamMain y se vuelca con el siguiente oamUpdate (p.ej. el de cada frame en eventMgr_UpdatePhases).
+ * Útil para actualizar muchos sprites y volcarlos de una sola vez.
+ * @param index
+ * @param x
+ * @param y
+ * @param isHidden
+ */
+void sprites_setSprite(uint8 index, int x, int y, bool isHidden){
+    sprites_setSpriteGfx(index, sprites[index]->gfx, x, y, isHidden);
+    sprites[index]->spriteEntry = &oamMain.oamMemory[index];
+}
+
+/**
+ * @brief Igual que @fn sprites_setSprite, pero con el GFX indicado, para índices OAM que no tienen
+ * @struct Sprite asociado (p.ej. las celdas de las matrices, que solo guardan su índice).
+ * @param index
+ * @param gfx GFX a mostrar.
+ * @param x
+ * @param y
+ * @param isHidden
+ */
+void sprites_setSpriteGfx(uint8 index, GfxData* gfx, int x, int y, bool isHidden){
     oamSet(&oamMain,
            index,
            x, y,
            0,
            0,
-           sprites[index]->gfx->size,
-           sprites[index]->gfx->colorFormat,
-           sprites[index]->gfx->memAddress,
+           gfx->size,
+           gfx->colorFormat,
+           gfx->memAddress,
            -1,
            false,
            isHidden,
            false, false,
            false
     );
-    oamUpdate(&oamMain);
-
-    sprites[index]->spriteEntry = &oamMain.oamMemory[index];
 }
 
 void sprites_updateSprite(uint8 index){
@@ -204,7 +240,7 @@ void sprites_updateSprite(uint8 index){
  * @param index
  * @return Puntero a elemento @struct Sprite.
  */
-Sprite* getSpriteByIndex(uint8 index){
+Sprite* sprites_getSpriteByIndex(uint8 index){
     return sprites[index];
 }
 
@@ -214,7 +250,7 @@ Sprite* getSpriteByIndex(uint8 index){
  * @param index
  * @return
  */
-SpriteEntry* getSpriteEntryByIndex(uint8 index){
+SpriteEntry* sprites_getSpriteEntryByIndex(uint8 index){
     return &oamMain.oamMemory[index];
 }
 
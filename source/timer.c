@@ -50,9 +50,40 @@ void timer_ConfigureTimer(int latch, int mask)
 
     TIMER0_CNT |= 0x00C0 | timer.conf;
     TIMER0_DAT |= timer.latch;
+    timer_StartCycleCounter();
     timer_StartTimer();
 }
 
+/**
+ * @brief Pone en marcha el contador de ciclos (TIMER2 y TIMER3 en cascada) desde 0.
+ * No genera interrupciones.
+ */
+void timer_StartCycleCounter(){
+    TIMER2_CNT = 0;
+    TIMER3_CNT = 0;
+    TIMER2_DAT = 0;
+    TIMER3_DAT = 0;
+    TIMER3_CNT = BIT(7) | BIT(2); // Encendido, cuenta los desbordamientos de TIMER2.
+    TIMER2_CNT = BIT(7); // Encendido, frecuencia del bus.
+}
+
+/**
+ * @brief Lee el contador de ciclos. La parte alta se vuelve a leer para no mezclar las dos
+ * mitades si TIMER2 desborda entre medias. Las diferencias entre lecturas son correctas aunque
+ * el contador dé la vuelta.
+ * @return Ciclos de bus desde @fn timer_StartCycleCounter.
+ */
+uint32_t timer_ReadCycleCounter(){
+    uint16_t high, low;
+
+    do{
+        high = TIMER3_DAT;
+        low = TIMER2_DAT;
+    }while(high != TIMER3_DAT);
+
+    return ((uint32_t) high << 16) | low;
+}
+
 /**
  * @brief Invocada por la rutina de atención del timer.
  * Establecemos, 512 ticks - ~1 segundo.
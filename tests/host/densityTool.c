@@ -0,0 +1,193 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file densityTool.c
+ * @brief Generador de matrices con densidad acotada (@fn matrixPool_generateEntry): cuánto cuesta
+ * cada matriz, cuántas se descartan, y el histograma de pivots con overflow por dificultad de una
+ * permutación sin más (un solo intento) frente al de las matrices generadas. Las generadas dentro
+ * de sus intentos tienen que caer siempre dentro de la banda.
+ *
+ * También regenera las bandas por defecto de cada regla y forma (@var overflowRuleBands) y comprueba
+ * que son las que hay en matrixPool.c; si no, imprime la tabla nueva para sustituirla.
+ */
+
+#include "hostBench.h"
+#include "matrixPool.h"
+#include "game.h"
+
+#define DENSITY_ENTRIES 20000
+#define DENSITY_BAR_WIDTH 40
+#define DENSITY_BAND_ENTRIES 50000
+#define DENSITY_BAND_LOW 10 // %, permutaciones más dispersas que se descartan.
+#define DENSITY_BAND_HIGH 99 // %, permutaciones que quedan por debajo del máximo.
+
+static MatrixPoolEntry entry;
+static long rawCounts[OVERFLOW_MAPS][MATRIX_MAX_CELLS];
+static long generatedCounts[OVERFLOW_MAPS][MATRIX_MAX_CELLS];
+
+void densityTool_run(uint8 size, bool histogram){
+    RngState rng;
+    long rejected = 0, outOfBand = 0;
+    double start, ns;
+
+    matrix_initSystem(size);
+    matrixPool_init();
+    rng_seed(&rng, size);
+
+    for(int n = 0; n < DENSITY_ENTRIES; n++){
+        matrixPool_generateEntry(&rng, &entry, 1);
+        for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+            rawCounts[mode][matrix_countOverflows(&entry.overflowMaps[mode], size)]++;
+    }
+
+    start = hostBench_now();
+    for(int n = 0; n < DENSITY_ENTRIES; n++){
+        uint8 attempts = matrixPool_generateEntry(&rng, &entry, MATRIX_POOL_MAX_ATTEMPTS);
+
+        rejected += attempts;
+        if(attempts == MATRIX_POOL_MAX_ATTEMPTS){
+            outOfBand++;
+            continue;
+        }
+        HOST_CHECK(matrixPool_isInBand(entry.overflowMaps));
+        for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+            generatedCounts[mode][matrix_countOverflows(&entry.overflowMaps[mode], size)]++;
+    }
+    ns = (hostBench_now() - start) / DENSITY_ENTRIES;
+
+    printf("densityTool: %dx%d, %.1f us/matriz, %.2f descartes/matriz, %.2f%% fuera de banda, "
+           "bandas NM [%d, %d] HM [%d, %d]\n", size, size, ns / 1000, (double) rejected / DENSITY_ENTRIES,
+           100.0 * outOfBand / DENSITY_ENTRIES, overflowBands[DIFFICULTY_NORMAL_MODE].min,
+           overflowBands[DIFFICULTY_NORMAL_MODE].max, overflowBands[DIFFICULTY_HARD_MODE].min,
+           overflowBands[DIFFICULTY_HARD_MODE].max);
+
+    if(!histogram)
+        return;
+
+    for(int mode = 0; mode < OVERFLOW_MAPS; mode++){
+        printf("  %s  overflows  permutación  generada\n", mode == DIFFICULTY_NORMAL_MODE ? "NM" : "HM");
+        for(int count = 0; count <= MATRIX_PIVOTS_I(size) * MATRIX_PIVOTS_J(size); count++){
+            if(!rawCounts[mode][count] && !generatedCounts[mode][count])
+                continue;
+            printf("      %c %3d  %6.2f%%  %6.2f%%  ", count >= overflowBands[mode].min
+                   && count <= overflowBands[mode].max ? '|' : ' ', count,
+                   100.0 * rawCounts[mode][count] / DENSITY_ENTRIES, 100.0 * generatedCounts[mode][count] / DENSITY_ENTRIES);
+            for(int bar = 0; bar < generatedCounts[mode][count] * DENSITY_BAR_WIDTH * 8 / DENSITY_ENTRIES; bar++)
+                putchar('#');
+            putchar('\n');
+        }
+    }
+}
+
+/**
+ * @brief Banda de un histograma de overflows: el mínimo deja fuera como mucho el
+ * @def DENSITY_BAND_LOW % más disperso, y el máximo deja dentro al menos el @def DENSITY_BAND_HIGH %.
+ */
+OverflowBand densityTool_band(const long* counts, long entries){
+    OverflowBand band = { 0, 0 };
+    long below = 0;
+    bool low = false;
+
+    for(int count = 0; count < MATRIX_MAX_CELLS; count++){
+        below += counts[count];
+        if(!low && below * 100 > entries * DENSITY_BAND_LOW){
+            band.min = count;
+            low = true;
+        }
+        if(below * 100 >= entries * DENSITY_BAND_HIGH){
+            band.max = count;
+            break;
+        }
+    }
+
+    return band;
+}
+
+/**
+ * @brief Bandas por defecto de cada regla y forma: percentiles @def DENSITY_BAND_LOW y
+ * @def DENSITY_BAND_HIGH de los overflows de @def DENSITY_BAND_ENTRIES permutaciones de la matriz base
+ * de 10x10 (@def OVERFLOW_BAND_PIVOTS pivots), con la misma semilla en todas. Tienen que coincidir
+ * con @var overflowRuleBands; si no, se imprime la tabla regenerada.
+ */
+void densityTool_bands(){
+    static const char* rules[OVERFLOW_RULES] = { "ROWS", "COLUMNS", "DIAGONALS", "SIGNED_ROWS", "ANY_ROW" };
+    static const char* shapes[BITBLOCK_SHAPES] = { "SQUARE", "PLUS", "L", "LINE", "SMALL_SQUARE" };
+    static OverflowBand bands[OVERFLOW_RULES][BITBLOCK_SHAPES][OVERFLOW_MAPS];
+    static long counts[OVERFLOW_MAPS][MATRIX_MAX_CELLS];
+    bool same = true;
+
+    matrix_initSystem(MATRIX_DEFAULT_SIZE);
+    matrixPool_init();
+    HOST_CHECK(MATRIX_PIVOTS_I(MATRIX_DEFAULT_SIZE) * MATRIX_PIVOTS_J(MATRIX_DEFAULT_SIZE) == OVERFLOW_BAND_PIVOTS);
+
+    for(int rule = 0; rule < OVERFLOW_RULES; rule++)
+        for(int shape = 0; shape < BITBLOCK_SHAPES; shape++){
+            RngState rng;
+
+            gameData.rule = rule;
+            gameData.shape = shape;
+            matrix_selectBitBlockEvaluation(rule, shape);
+            rng_seed(&rng, 1);
+            for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+                for(int count = 0; count < MATRIX_MAX_CELLS; count++)
+                    counts[mode][count] = 0;
+            for(int n = 0; n < DENSITY_BAND_ENTRIES; n++){
+                matrixPool_generateEntry(&rng, &entry, 1);
+                for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+                    counts[mode][matrix_countOverflows(&entry.overflowMaps[mode], MATRIX_DEFAULT_SIZE)]++;
+            }
+            for(int mode = 0; mode < OVERFLOW_MAPS; mode++){
+                bands[rule][shape][mode] = densityTool_band(counts[mode], DENSITY_BAND_ENTRIES);
+                same &= bands[rule][shape][mode].min == overflowRuleBands[rule][shape][mode].min
+                        && bands[rule][shape][mode].max == overflowRuleBands[rule][shape][mode].max;
+            }
+        }
+
+    gameData.rule = GAME_DEFAULT_RULE;
+    gameData.shape = GAME_DEFAULT_SHAPE;
+    matrix_selectBitBlockEvaluation(GAME_DEFAULT_RULE, GAME_DEFAULT_SHAPE);
+
+    if(!same){
+        printf("densityTool: overflowRuleBands no coincide con las bandas regeneradas:\n");
+        for(int rule = 0; rule < OVERFLOW_RULES; rule++){
+            printf("    [OVERFLOW_RULE_%s] = {\n", rules[rule]);
+            for(int shape = 0; shape < BITBLOCK_SHAPES; shape++)
+                printf("        [BITBLOCK_SHAPE_%s] = { { %d, %d }, { %d, %d } }%s\n", shapes[shape],
+                       bands[rule][shape][0].min, bands[rule][shape][0].max, bands[rule][shape][1].min,
+                       bands[rule][shape][1].max, shape < BITBLOCK_SHAPES - 1 ? "," : "");
+            printf("    }%s\n", rule < OVERFLOW_RULES - 1 ? "," : "");
+        }
+    }
+    HOST_CHECK(same);
+    printf("densityTool: bandas P%d-P%d de %d permutaciones iguales a overflowRuleBands (%d reglas x %d formas)\n",
+           DENSITY_BAND_LOW, DENSITY_BAND_HIGH, DENSITY_BAND_ENTRIES, OVERFLOW_RULES, BITBLOCK_SHAPES);
+}
+
+int main(){
+    rng_initSystem(RNG_DEFAULT_SEED);
+
+    densityTool_bands();
+    densityTool_run(MATRIX_DEFAULT_SIZE, true);
+    densityTool_run(MATRIX_MAX_SIZE, false);
+
+    return 0;
+}
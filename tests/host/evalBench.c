@@ -0,0 +1,119 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file evalBench.c
+ * @brief Evaluación de bloques por tabla (@fn matrix_evalBitBlockOverflow) frente al evaluador
+ * original con pow() en doubles: primero comprueba que ambos, y el mapa de una pasada
+ * (@fn matrix_computeOverflowMap), dan el mismo veredicto en todos los pivots de muchos tableros y en
+ * los dos modos, después mide el coste de cada uno.
+ */
+
+#include <math.h>
+#include "hostBench.h"
+#include "matrix.h"
+#include "game.h"
+
+#define EVAL_BOARDS 2000
+#define EVAL_ROUNDS 100000
+
+static Binary cells[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE];
+volatile int sink;
+
+/**
+ * @brief El evaluador de antes de la tabla, tal cual, sobre una copia de la matriz en celdas.
+ */
+__attribute__((noinline)) bool evalBench_powEval(uint8 pi, uint8 pj){
+    int decValue = 0;
+    for(int i = -1; i <= 1; i++){
+        double power = BITBLOCK_BASE_SIZE - 1;
+        for(int j = -1; j <= 1; j++){
+            decValue += cells[pi + i][pj + j] * pow(2, power);
+            power--;
+        }
+    }
+
+    return decValue > matrix_getOverflowLimit();
+}
+
+__attribute__((noinline)) bool evalBench_tableEval(uint8 pi, uint8 pj){
+    pivot->i = pi;
+    pivot->j = pj;
+    return matrix_evalBitBlockOverflow();
+}
+
+void evalBench_loadBoard(RngState* rng, uint8 size){
+    for(int i = 0; i < size; i++){
+        matrix[i] = rng_next(rng) & ((1u << size) - 1);
+        for(int j = 0; j < size; j++)
+            cells[i][j] = matrix_getBit(i, j);
+    }
+    matrix_refreshRowWindows(0, size);
+}
+
+double evalBench_time(bool (*eval)(uint8, uint8), uint8 size){
+    double start = hostBench_now();
+
+    for(int n = 0; n < EVAL_ROUNDS; n++)
+        for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(size); i++)
+            for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(size); j++)
+                sink += eval(i, j);
+
+    return (hostBench_now() - start) / EVAL_ROUNDS
+           / ((MATRIX_LAST_PIVOT_I(size) - MATRIX_FIRST_PIVOT_I + 1) * (MATRIX_LAST_PIVOT_J(size) - MATRIX_FIRST_PIVOT_J + 1));
+}
+
+int main(){
+    RngState rng;
+    uint8 size;
+    long checked = 0;
+
+    rng_initSystem(RNG_DEFAULT_SEED);
+    rng_seed(&rng, 2);
+    matrix_initSystem(MATRIX_DEFAULT_SIZE);
+    size = matrix_getSize();
+
+    for(int b = 0; b < EVAL_BOARDS; b++){
+        evalBench_loadBoard(&rng, size);
+        for(int mode = DIFFICULTY_NORMAL_MODE; mode <= DIFFICULTY_HARD_MODE; mode++){
+            MatrixPivot before = *pivot;
+            OverflowMap map;
+
+            gameData.mode = mode;
+            matrix_computeOverflowMap(&map);
+            HOST_CHECK(pivot->i == before.i && pivot->j == before.j);
+            for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(size); i++)
+                for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(size); j++){
+                    bool overflow = evalBench_powEval(i, j);
+
+                    HOST_CHECK(overflow == evalBench_tableEval(i, j));
+                    HOST_CHECK(overflow == ((map.rows[i] & OVERFLOW_ROW_BIT(j)) != 0));
+                    checked++;
+                }
+        }
+    }
+
+    gameData.mode = DIFFICULTY_HARD_MODE;
+    printf("evalBench: %ld veredictos iguales; pow() %.1f ns/eval, tabla %.1f ns/eval\n", checked,
+           evalBench_time(evalBench_powEval, size), evalBench_time(evalBench_tableEval, size));
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file eventBench.c
+ * @brief Coste de la rueda de tiempo del eventMgr con 20, 100, 1000 y 10000 eventos pendientes,
+ * a través de la propia interrupción (@fn eventMgr_UpdateScheduledEvents, un tick por llamada):
+ *  - un tick sin nada que vencer (todos los eventos a más de 10 segundos);
+ *  - ticks con eventos venciendo: cada evento, al ejecutarse, se vuelve a programar a entre 1 y
+ *    600 ticks, de manera que siempre hay N pendientes;
+ *  - el barrido lineal de antes de la rueda, que recorría todos los pendientes en cada tick.
+ * 10000 pendientes no caben en el pool por defecto: el Makefile compila con -DEVENT_POOL_SIZE.
+ */
+
+#include "hostBench.h"
+#include "eventMgr.h"
+#include "rng.h"
+#include "game.h"
+
+#define EVENT_BENCH_ID EVENT_SHOW_STATS
+#define EVENT_BENCH_MAX_DELAY 600
+#define EVENT_BENCH_IDLE_DELAY EVENT_SECONDS(10)
+#define EVENT_BENCH_IDLE_TICKS 4000
+#define EVENT_BENCH_BUSY_TICKS 20000
+#define EVENT_BENCH_SCAN_TICKS 2000
+
+static RngState rng;
+static int scanDeadlines[EVENT_POOL_SIZE];
+static long fired;
+volatile long sink;
+
+void eventBench_reschedule(){
+    fired++;
+    HOST_CHECK(eventMgr_ScheduleEvent(EVENT_BENCH_ID, 1 + rng_bounded(&rng, EVENT_BENCH_MAX_DELAY)) != EVENT_HANDLE_NONE);
+}
+
+double eventBench_ticks(int ticks){
+    double start = hostBench_now();
+
+    for(int t = 0; t < ticks; t++){
+        timer.totalTicks++;
+        eventMgr_UpdateScheduledEvents();
+    }
+
+    return (hostBench_now() - start) / ticks;
+}
+
+/**
+ * @brief El tick de antes: recorrer todos los pendientes comparando su plazo.
+ */
+__attribute__((noinline)) double eventBench_scan(int pending){
+    double start = hostBench_now();
+
+    for(int t = 0; t < EVENT_BENCH_SCAN_TICKS; t++)
+        for(int k = 0; k < pending; k++)
+            if(scanDeadlines[k] <= t)
+                sink++;
+
+    return (hostBench_now() - start) / EVENT_BENCH_SCAN_TICKS;
+}
+
+int main(){
+    const int pending[] = {20, 100, 1000, 10000};
+
+    rng_seed(&rng, 22);
+    gameData.state = GAME_STATE_GAME;
+
+    for(int p = 0; p < sizeof(pending) / sizeof(pending[0]); p++){
+        int n = pending[p];
+        double idle, busy;
+
+        HOST_CHECK(n <= EVENT_POOL_SIZE);
+        timer.totalTicks = 0;
+        eventMgr_InitEventSystem();
+
+        for(int k = 0; k < n; k++)
+            eventMgr_ScheduleEvent(EVENT_BENCH_ID, EVENT_BENCH_IDLE_DELAY + rng_bounded(&rng, EVENT_BENCH_MAX_DELAY));
+        idle = eventBench_ticks(EVENT_BENCH_IDLE_TICKS);
+        HOST_CHECK(eventPoolStats.inUse == n);
+
+        eventMgr_InitEventSystem();
+        eventMgr_RegisterHandler(EVENT_BENCH_ID, eventBench_reschedule);
+        for(int k = 0; k < n; k++){
+            eventMgr_ScheduleEvent(EVENT_BENCH_ID, 1 + rng_bounded(&rng, EVENT_BENCH_MAX_DELAY));
+            scanDeadlines[k] = EVENT_BENCH_SCAN_TICKS + rng_bounded(&rng, EVENT_BENCH_MAX_DELAY);
+        }
+        fired = 0;
+        busy = eventBench_ticks(EVENT_BENCH_BUSY_TICKS);
+        HOST_CHECK(eventPoolStats.inUse == n && eventPoolStats.failed == 0);
+        HOST_CHECK(fired > 0);
+
+        printf("eventBench: %5d pendientes, tick vacío %.0f ns, tick %.0f ns (%.1f vencen/tick, %.0f ns/evento), "
+               "barrido lineal %.0f ns/tick\n", n, idle, busy, (double) fired / EVENT_BENCH_BUSY_TICKS,
+               busy * EVENT_BENCH_BUSY_TICKS / fired, eventBench_scan(n));
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file eventStubs.c
+ * @brief Lo que eventMgr.c necesita del resto del juego para enlazar en el PC, además de stubs.c: el
+ * contador de ciclos y los efectos de las fases, que aquí no hacen nada.
+ */
+
+#include "game.h"
+#include "matrix.h"
+#include "movementMgr.h"
+#include "objectMgr.h"
+#include "timer.h"
+
+Animation* animations[ANIMATIONS_SIZE];
+
+uint32_t timer_ReadCycleCounter(){
+    return 0;
+}
+
+void game_setDestroyMatrix(bool active){}
+void game_enableDestroyMatrix(){}
+void game_increaseMatrixRegens(){}
+
+bool matrix_destroyMatrixEffect(){ return false; }
+void matrix_updatePivot(uint8 i, uint8 j){}
+bool matrix_dropBitBlockEffect(){ return false; }
+bool matrix_revealMatrixEffect(){ return false; }
+void matrix_bitShakeEffect(int8 state){}
+bool matrix_collapseEffect(){ return false; }
+uint8 matrix_commitView(){ return 0; }
+
+bool movementMgr_nextPositionReached(MovementGfx movGfx){ return false; }
+uint8 movementMgr_getPositionX(){ return 0; }
+uint8 movementMgr_getPositionY(){ return 0; }
+bool movementMgr_hasGfxReachedDest(GfxID gfxId){ return false; }
+
+void objectMgr_setAnimationActive(AnimID animID, bool active){}
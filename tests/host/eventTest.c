@@ -0,0 +1,317 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file eventTest.c
+ * @brief Corrección del eventMgr, a través de la propia interrupción
+ * (@fn eventMgr_UpdateScheduledEvents, un tick por llamada):
+ *  - con el pool lleno no se programa nada (EVENT_HANDLE_NONE, contado en @var eventPoolStats) y
+ *    los huecos que se devuelven se vuelven a servir;
+ *  - cada evento baja por los niveles de la rueda y vence justo en su plazo, también en el
+ *    horizonte y más allá, empiece la rueda alineada o no;
+ *  - los plazos en ticks no tienen deriva: un evento que se vuelve a programar desde su propia
+ *    función vence cada d ticks exactos, y NO_WAIT en la siguiente pasada (en el mismo tick si se
+ *    programa desde la interrupción);
+ *  - un identificador caduca cuando su hueco vuelve al pool, y cancelar un evento que ya está en
+ *    @var eventReady (también desde otro evento del mismo tick) impide que se ejecute; un evento
+ *    cancelado sigue ocupando su hueco hasta que vence su plazo.
+ * Usa el pool por defecto, el mismo que el juego.
+ */
+
+#include "hostBench.h"
+#include "eventMgr.h"
+#include "game.h"
+
+#define EVENT_TEST_A EVENT_SHOW_STATS
+#define EVENT_TEST_CHAIN EVENT_RESET
+#define EVENT_TEST_CHAIN_LENGTH 40
+#define EVENT_TEST_CANCEL EVENT_LISTEN_INPUT
+#define EVENT_TEST_FAR EVENT_SECONDS(10)
+#define EVENT_TEST_LOG 64
+
+extern uint64 eventWheelOccupied[EVENT_WHEEL_LEVELS];
+
+static int firedA;
+static int firedAtA;
+static int firedLog[EVENT_TEST_LOG];
+
+void eventTest_fireA(){
+    if(firedA < EVENT_TEST_LOG)
+        firedLog[firedA] = timer.totalTicks;
+    firedA++;
+    firedAtA = timer.totalTicks;
+}
+
+static int chainDelay;
+static int chainFired;
+static int chainLog[EVENT_TEST_CHAIN_LENGTH];
+
+/**
+ * @brief Se vuelve a programar con @var chainDelay hasta vencer EVENT_TEST_CHAIN_LENGTH veces.
+ */
+void eventTest_chain(){
+    chainLog[chainFired++] = timer.totalTicks;
+    if(chainFired < EVENT_TEST_CHAIN_LENGTH)
+        HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_CHAIN, chainDelay) != EVENT_HANDLE_NONE);
+}
+
+static EventHandle cancelTarget;
+static bool cancelResult;
+
+/**
+ * @brief Cancela @var cancelTarget desde la interrupción.
+ */
+void eventTest_cancelTarget(){
+    cancelResult = eventMgr_CancelEvent(cancelTarget);
+}
+
+/**
+ * @brief Reinicia el eventMgr en el instante dado, con el manejador de prueba registrado.
+ * @param now Tick en el que arranca la rueda.
+ */
+void eventTest_reset(int now){
+    timer.totalTicks = now;
+    eventMgr_InitEventSystem();
+    eventMgr_RegisterHandler(EVENT_TEST_A, eventTest_fireA);
+    eventMgr_RegisterHandler(EVENT_TEST_CHAIN, eventTest_chain);
+    eventMgr_RegisterHandler(EVENT_TEST_CANCEL, eventTest_cancelTarget);
+    firedA = chainFired = 0;
+    firedAtA = -1;
+}
+
+/**
+ * @brief Avanza el timer tick a tick, como la interrupción.
+ * @param ticks Ticks a avanzar.
+ */
+void eventTest_ticks(int ticks){
+    for(int t = 0; t < ticks; t++){
+        timer.totalTicks++;
+        eventMgr_UpdateScheduledEvents();
+    }
+}
+
+/**
+ * @brief Índice del hueco del pool de un identificador.
+ */
+uint16 eventTest_slot(EventHandle handle){
+    return (handle & 0xFFFF) - 1;
+}
+
+/**
+ * @brief Pool lleno: el evento que no cabe no se programa y se cuenta; al vencer los pendientes
+ * el pool se vacía y los huecos se sirven de nuevo, el último devuelto el primero.
+ */
+void eventTest_pool(){
+    EventHandle handles[EVENT_POOL_SIZE];
+    EventHandle handle;
+
+    eventTest_reset(0);
+    for(int k = 0; k < EVENT_POOL_SIZE; k++){
+        handles[k] = eventMgr_ScheduleEvent(EVENT_TEST_A, EVENT_TEST_FAR + k);
+        HOST_CHECK(handles[k] != EVENT_HANDLE_NONE);
+        for(int prev = 0; prev < k; prev++)
+            HOST_CHECK(eventTest_slot(handles[prev]) != eventTest_slot(handles[k]));
+    }
+    HOST_CHECK(eventPoolStats.inUse == EVENT_POOL_SIZE && eventPoolStats.peak == EVENT_POOL_SIZE);
+    HOST_CHECK(eventPoolStats.acquired == EVENT_POOL_SIZE && eventPoolStats.failed == 0);
+
+    HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_A, NO_WAIT) == EVENT_HANDLE_NONE);
+    HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_A, 1) == EVENT_HANDLE_NONE);
+    HOST_CHECK(eventPoolStats.failed == 2 && eventPoolStats.acquired == EVENT_POOL_SIZE);
+    HOST_CHECK(eventPoolStats.inUse == EVENT_POOL_SIZE);
+    eventTest_ticks(1);
+    HOST_CHECK(firedA == 0);
+
+    // Vence el primero: su hueco vuelve al pool y es el siguiente que se sirve.
+    eventTest_ticks(EVENT_TEST_FAR - 1);
+    HOST_CHECK(firedA == 1 && eventPoolStats.inUse == EVENT_POOL_SIZE - 1);
+    handle = eventMgr_ScheduleEvent(EVENT_TEST_A, EVENT_TEST_FAR);
+    HOST_CHECK(handle != EVENT_HANDLE_NONE && eventTest_slot(handle) == eventTest_slot(handles[0]));
+    HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_A, EVENT_TEST_FAR) == EVENT_HANDLE_NONE);
+
+    eventTest_ticks(EVENT_TEST_FAR);
+    HOST_CHECK(firedA == EVENT_POOL_SIZE + 1 && eventPoolStats.inUse == 0);
+    HOST_CHECK(eventPoolStats.peak == EVENT_POOL_SIZE && eventPoolStats.failed == 3);
+
+    // Con todo devuelto, el pool entero se vuelve a servir.
+    for(int k = 0; k < EVENT_POOL_SIZE; k++)
+        HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_A, 1 + k % 7) != EVENT_HANDLE_NONE);
+    HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_A, 1) == EVENT_HANDLE_NONE);
+    eventTest_ticks(7);
+    HOST_CHECK(eventPoolStats.inUse == 0 && firedA == 2 * EVENT_POOL_SIZE + 1);
+
+    // Vaciar el juego también devuelve los huecos.
+    for(int k = 0; k < EVENT_POOL_SIZE; k++)
+        eventMgr_ScheduleEvent(EVENT_TEST_A, NO_WAIT + (k & 1) * EVENT_TEST_FAR);
+    eventMgr_cancelAllEvents();
+    HOST_CHECK(eventPoolStats.inUse == 0);
+    eventTest_ticks(EVENT_TEST_FAR + 1);
+    HOST_CHECK(firedA == 2 * EVENT_POOL_SIZE + 1);
+}
+
+/**
+ * @brief Nivel de la rueda en el que hay algo pendiente, o -1 si está vacía. Sólo tiene sentido con
+ * un único evento programado.
+ */
+int eventTest_occupiedLevel(){
+    for(int level = 0; level < EVENT_WHEEL_LEVELS; level++)
+        if(eventWheelOccupied[level] != 0)
+            return level;
+
+    return -1;
+}
+
+/**
+ * @brief Plazos en los bordes de cada nivel y del horizonte: el evento entra en el nivel que le
+ * toca, se reparte hacia abajo y vence en el tick exacto, una sola vez. Se repite con la rueda
+ * arrancando alineada, a mitad de un hueco y justo antes de que den la vuelta los niveles 1 y 2.
+ * Después todos a la vez, para ver que compartir hueco no cambia nada.
+ */
+void eventTest_wheel(){
+    const int starts[] = {0, 37, EVENT_WHEEL_SPAN(2) - 3, 5 * EVENT_WHEEL_SPAN(2) + 1000};
+    const int delays[] = {1, 2, EVENT_WHEEL_SLOTS - 1, EVENT_WHEEL_SLOTS, EVENT_WHEEL_SLOTS + 1,
+                          EVENT_WHEEL_SPAN(2) - 1, EVENT_WHEEL_SPAN(2), EVENT_WHEEL_SPAN(2) + 1,
+                          EVENT_WHEEL_HORIZON - 1, EVENT_WHEEL_HORIZON, EVENT_WHEEL_HORIZON + 1,
+                          2 * EVENT_WHEEL_HORIZON + 77};
+    const int count = sizeof(delays) / sizeof(delays[0]);
+
+    for(int s = 0; s < sizeof(starts) / sizeof(starts[0]); s++){
+        for(int d = 0; d < count; d++){
+            int level = delays[d] < EVENT_WHEEL_SPAN(1) ? 0 : delays[d] < EVENT_WHEEL_SPAN(2) ? 1 : 2;
+
+            eventTest_reset(starts[s]);
+            HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_A, delays[d]) != EVENT_HANDLE_NONE);
+            HOST_CHECK(eventTest_occupiedLevel() == level);
+            eventTest_ticks(delays[d] - 1);
+            HOST_CHECK(firedA == 0 && eventPoolStats.inUse == 1);
+            eventTest_ticks(1);
+            HOST_CHECK(firedA == 1 && firedAtA == starts[s] + delays[d]);
+            HOST_CHECK(eventPoolStats.inUse == 0 && eventTest_occupiedLevel() == -1);
+            eventTest_ticks(EVENT_WHEEL_SPAN(2));
+            HOST_CHECK(firedA == 1);
+        }
+
+        // Todos a la vez, programados de mayor a menor: vencen en orden de plazo.
+        eventTest_reset(starts[s]);
+        for(int d = count - 1; d >= 0; d--)
+            HOST_CHECK(eventMgr_ScheduleEvent(EVENT_TEST_A, delays[d]) != EVENT_HANDLE_NONE);
+        eventTest_ticks(delays[count - 1]);
+        HOST_CHECK(firedA == count && eventPoolStats.inUse == 0);
+        for(int d = 0; d < count; d++)
+            HOST_CHECK(firedLog[d] == starts[s] + delays[d]);
+    }
+}
+
+/**
+ * @brief Plazos en ticks: las marcas de tiempo redondean al tick más cercano, NO_WAIT vence en la
+ * siguiente pasada y una cadena de eventos que se reprograman a sí mismos mantiene el paso exacto.
+ */
+void eventTest_deadlines(){
+    const int delays[] = {NO_WAIT, 1, 3, IN_100_MS, IN_250_MS, IN_750_MS, IN_1_SECONDS, IN_3_SECONDS};
+
+    HOST_CHECK(EVENT_SECONDS(1) == TIMER0_FREQ && EVENT_MS(1000) == TIMER0_FREQ);
+    HOST_CHECK(IN_100_MS == 51 && IN_250_MS == 128 && IN_500_MS == 256 && IN_750_MS == 384);
+    HOST_CHECK(EVENT_MS(1) == 1 && EVENT_MS(0) == 0);
+
+    // Desde el loop principal, NO_WAIT vence en la siguiente pasada aunque el timer no avance.
+    eventTest_reset(100);
+    eventMgr_ScheduleEvent(EVENT_TEST_A, NO_WAIT);
+    eventMgr_UpdateScheduledEvents();
+    HOST_CHECK(firedA == 1 && firedAtA == 100);
+
+    for(int d = 0; d < sizeof(delays) / sizeof(delays[0]); d++){
+        eventTest_reset(1234);
+        chainDelay = delays[d];
+        eventMgr_ScheduleEvent(EVENT_TEST_CHAIN, chainDelay);
+        eventTest_ticks(EVENT_TEST_CHAIN_LENGTH * chainDelay);
+        if(chainDelay == NO_WAIT)
+            eventTest_ticks(1);
+        HOST_CHECK(chainFired == EVENT_TEST_CHAIN_LENGTH && eventPoolStats.inUse == 0);
+        HOST_CHECK(chainLog[0] == 1234 + (chainDelay == NO_WAIT ? 1 : chainDelay));
+        for(int k = 1; k < EVENT_TEST_CHAIN_LENGTH; k++)
+            HOST_CHECK(chainLog[k] - chainLog[k - 1] == chainDelay);
+    }
+}
+
+/**
+ * @brief Identificadores y cancelación: el de un evento ya ejecutado o cancelado no vale para el
+ * que reutiliza su hueco, cancelar un evento ya vencido pero aún no ejecutado lo descarta, y el
+ * hueco de un evento cancelado no vuelve al pool hasta su plazo.
+ */
+void eventTest_cancel(){
+    EventHandle first, second, third;
+
+    eventTest_reset(0);
+    first = eventMgr_ScheduleEvent(EVENT_TEST_A, 5);
+    eventTest_ticks(5);
+    HOST_CHECK(firedA == 1);
+    second = eventMgr_ScheduleEvent(EVENT_TEST_A, 5);
+    HOST_CHECK(eventTest_slot(second) == eventTest_slot(first) && second != first);
+    HOST_CHECK(!eventMgr_CancelEvent(first));
+    HOST_CHECK(eventMgr_CancelEvent(second));
+    HOST_CHECK(!eventMgr_CancelEvent(second));
+    eventTest_ticks(5);
+    HOST_CHECK(firedA == 1 && eventPoolStats.inUse == 0);
+    third = eventMgr_ScheduleEvent(EVENT_TEST_A, 5);
+    HOST_CHECK(eventTest_slot(third) == eventTest_slot(first) && third != first && third != second);
+    HOST_CHECK(!eventMgr_CancelEvent(first) && !eventMgr_CancelEvent(second));
+    eventTest_ticks(5);
+    HOST_CHECK(firedA == 2 && !eventMgr_CancelEvent(third));
+    HOST_CHECK(!eventMgr_CancelEvent(EVENT_HANDLE_NONE));
+    HOST_CHECK(!eventMgr_CancelEvent(0x10000) && !eventMgr_CancelEvent(EVENT_POOL_SIZE + 1));
+
+    // Ya en eventReady, desde el loop principal.
+    eventTest_reset(0);
+    first = eventMgr_ScheduleEvent(EVENT_TEST_A, NO_WAIT);
+    HOST_CHECK(eventMgr_CancelEvent(first));
+    eventMgr_UpdateScheduledEvents();
+    HOST_CHECK(firedA == 0 && eventPoolStats.inUse == 0);
+
+    // Ya en eventReady, desde un evento que vence en el mismo tick justo antes.
+    eventTest_reset(0);
+    eventMgr_ScheduleEvent(EVENT_TEST_CANCEL, IN_100_MS);
+    cancelTarget = eventMgr_ScheduleEvent(EVENT_TEST_A, IN_100_MS);
+    cancelResult = false;
+    eventTest_ticks(IN_100_MS);
+    HOST_CHECK(cancelResult && firedA == 0 && eventPoolStats.inUse == 0);
+
+    // Cancelado a largo plazo: no se ejecuta, pero el hueco sigue ocupado hasta su plazo.
+    eventTest_reset(0);
+    first = eventMgr_ScheduleEvent(EVENT_TEST_A, EVENT_TEST_FAR);
+    HOST_CHECK(eventMgr_CancelEvent(first));
+    eventTest_ticks(EVENT_TEST_FAR - 1);
+    HOST_CHECK(eventPoolStats.inUse == 1);
+    eventTest_ticks(1);
+    HOST_CHECK(eventPoolStats.inUse == 0 && firedA == 0);
+}
+
+int main(){
+    gameData.state = GAME_STATE_GAME;
+
+    eventTest_pool();
+    eventTest_wheel();
+    eventTest_deadlines();
+    eventTest_cancel();
+    printf("eventTest: pool de %d eventos, rueda (horizonte %d ticks), plazos y cancelación correctos\n",
+           EVENT_POOL_SIZE, EVENT_WHEEL_HORIZON);
+
+    return 0;
+}
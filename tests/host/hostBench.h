@@ -0,0 +1,62 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file hostBench.h
+ * @brief Utilidades comunes de las pruebas de host: reloj y comprobaciones. Las comprobaciones
+ * terminan el programa con error, para que "make run" se pare en la primera que falle.
+ */
+
+#ifndef INATRIX_OVERFLOW_HOSTBENCH_H
+#define INATRIX_OVERFLOW_HOSTBENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define HOST_CHECK(cond) do{ if(!(cond)){ \
+        fprintf(stderr, "%s:%d: falla %s\n", __FILE__, __LINE__, #cond); exit(1); } }while(0)
+
+/**
+ * @brief Instante actual del reloj monótono.
+ * @return Nanosegundos.
+ */
+static inline double hostBench_now(){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ * @brief Coste de leer el reloj, para descontarlo de intervalos cortos.
+ * @return Nanosegundos entre dos lecturas seguidas, en media.
+ */
+static inline double hostBench_overhead(){
+    double start = hostBench_now();
+
+    for(int n = 0; n < 1000; n++)
+        hostBench_now();
+
+    return (hostBench_now() - start) / 1000;
+}
+
+#endif //INATRIX_OVERFLOW_HOSTBENCH_H
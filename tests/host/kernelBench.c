@@ -0,0 +1,130 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file kernelBench.c
+ * @brief Una instancia del kernel de bloque (bitBlockKernel.h) por binario: el Makefile lo compila
+ * una vez por geometría (-DBITBLOCK_ROWS/-DBITBLOCK_COLS). Comprueba cada patrón contra una
+ * evaluación de referencia con bucles y mide, con la regla y la forma por defecto:
+ *  - una evaluación (patrón desde @var rowWindows + tabla o suma de filas) frente a un evaluador
+ *    genérico que recorre el bloque con bucles de tamaño no conocido al compilar;
+ *  - el cálculo de los mapas de overflow de un tablero entero.
+ */
+
+#include "hostBench.h"
+#include "matrix.h"
+#include "game.h"
+
+#define KERNEL_BOARD_SIZE MATRIX_DEFAULT_SIZE
+#define KERNEL_BOARDS 200
+#define KERNEL_ROUNDS 500
+
+static OverflowMap maps[OVERFLOW_MAPS];
+volatile uint8 blockRows = BITBLOCK_ROWS, blockCols = BITBLOCK_COLS;
+volatile int sink;
+
+/**
+ * @brief Evaluador de referencia (regla de filas, bloque entero) sobre un patrón.
+ */
+uint8 kernelBench_reference(uint16 pattern){
+    int value = 0;
+
+    for(int row = 0; row < BITBLOCK_ROWS; row++)
+        value += (pattern >> (BITBLOCK_COLS * (BITBLOCK_ROWS - 1 - row))) & BITBLOCK_MASK;
+
+    return value | ((value > OVERFLOW_NM) << BITBLOCK_VALUE_BITS) | ((value > OVERFLOW_HM) << (BITBLOCK_VALUE_BITS + 1));
+}
+
+/**
+ * @brief Evaluador genérico sobre la matriz: recorre el bloque celda a celda con bucles cuyo
+ * tamaño solo se conoce en ejecución, como haría un kernel sin especializar.
+ */
+__attribute__((noinline)) uint8 kernelBench_loopEval(uint8 pi, uint8 pj){
+    uint8 rows = blockRows, cols = blockCols;
+    int value = 0;
+
+    for(int i = 0; i < rows; i++){
+        int rowValue = 0;
+
+        for(int j = 0; j < cols; j++)
+            rowValue = (rowValue << 1) | BITBOARD_GET(matrix[pi - BITBLOCK_TOP + i], KERNEL_BOARD_SIZE, pj - BITBLOCK_LEFT + j);
+        value += rowValue;
+    }
+
+    return value | ((value > OVERFLOW_NM) << BITBLOCK_VALUE_BITS) | ((value > OVERFLOW_HM) << (BITBLOCK_VALUE_BITS + 1));
+}
+
+__attribute__((noinline)) uint8 kernelBench_kernelEval(uint8 pi, uint8 pj){
+    return matrix_evalBitBlock(matrix_getBitBlockPattern(pi, pj));
+}
+
+double kernelBench_time(uint8 (*eval)(uint8, uint8)){
+    double start = hostBench_now();
+
+    for(int n = 0; n < KERNEL_ROUNDS * 100; n++)
+        for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(KERNEL_BOARD_SIZE); i++)
+            for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(KERNEL_BOARD_SIZE); j++)
+                sink += eval(i, j);
+
+    return (hostBench_now() - start) / (KERNEL_ROUNDS * 100)
+           / (MATRIX_PIVOTS_I(KERNEL_BOARD_SIZE) * MATRIX_PIVOTS_J(KERNEL_BOARD_SIZE));
+}
+
+int main(){
+    RngState rng;
+    double start, mapNs;
+
+    rng_initSystem(RNG_DEFAULT_SEED);
+    rng_seed(&rng, 10);
+    matrix_initSystem(KERNEL_BOARD_SIZE);
+
+    for(int pattern = 0; pattern < BITBLOCK_PATTERNS; pattern++)
+        HOST_CHECK(matrix_evalBitBlock(pattern) == kernelBench_reference(pattern));
+
+    for(int b = 0; b < KERNEL_BOARDS; b++){
+        for(int i = 0; i < KERNEL_BOARD_SIZE; i++)
+            matrix[i] = rng_next(&rng) & ((1u << KERNEL_BOARD_SIZE) - 1);
+        matrix_refreshRowWindows(0, KERNEL_BOARD_SIZE);
+        matrix_buildOverflowMaps(matrix, KERNEL_BOARD_SIZE, maps);
+
+        for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(KERNEL_BOARD_SIZE); i++)
+            for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(KERNEL_BOARD_SIZE); j++){
+                uint8 entry = kernelBench_kernelEval(i, j);
+
+                HOST_CHECK(entry == kernelBench_loopEval(i, j));
+                for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+                    HOST_CHECK(!!(maps[mode].rows[i] & OVERFLOW_ROW_BIT(j)) == !!(entry & BITBLOCK_OVERFLOW_FLAG(mode)));
+            }
+    }
+
+    start = hostBench_now();
+    for(int n = 0; n < KERNEL_ROUNDS * 10; n++)
+        matrix_buildOverflowMaps(matrix, KERNEL_BOARD_SIZE, maps);
+    mapNs = (hostBench_now() - start) / (KERNEL_ROUNDS * 10);
+    sink += maps[0].rows[MATRIX_FIRST_PIVOT_I];
+
+    printf("kernelBench: %dx%d (%s), kernel %.1f ns/eval, bucles %.1f ns/eval, mapas %dx%d %.0f ns\n",
+           BITBLOCK_ROWS, BITBLOCK_COLS, BITBLOCK_LOOKUP_TABLE ? "tabla" : "suma de filas",
+           kernelBench_time(kernelBench_kernelEval), kernelBench_time(kernelBench_loopEval),
+           KERNEL_BOARD_SIZE, KERNEL_BOARD_SIZE, mapNs);
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file matrixTest.c
+ * @brief Corrección de lo que matrix.c deriva del bitboard, contrastado con un recálculo celda a
+ * celda con @fn matrix_getBit, en varios tamaños de matriz:
+ *  - la caché de ventanas (@var rowWindows) tras @fn matrix_setBit y @fn matrix_regenerateBitBlock,
+ *    con pivots en los bordes incluidos;
+ *  - el colapso por gravedad (@fn matrix_collapseBitBlock) con cada regla y forma: la matriz
+ *    resultante, la caché de ventanas y los mapas de overflow, que se actualizan sólo en la región
+ *    tocada, frente a rehacerlos enteros;
+ *  - @fn matrix_findNearestOverflow frente a recorrer todos los pivots, desde cualquier celda
+ *    (también fuera del rango de pivots) y con mapas de cualquier densidad, incluido el vacío
+ *    (@def HINT_NONE);
+ *  - la regeneración de la matriz: al terminar @fn matrix_revealMatrixEffect, repartido entre
+ *    frames, la caché de ventanas está entera al día con la matriz nueva.
+ */
+
+#include "hostBench.h"
+#include "matrixPool.h"
+#include "game.h"
+
+#define MATRIX_TEST_SET_BITS 2000
+#define MATRIX_TEST_BLOCKS 500
+#define MATRIX_TEST_COLLAPSES 40
+#define MATRIX_TEST_HINT_MAPS 200
+#define MATRIX_TEST_REGENS 50
+
+/**
+ * @brief Ventana de la fila i para el pivot de la columna j, leída celda a celda.
+ */
+uint8 matrixTest_window(uint8 i, uint8 j){
+    uint8 window = 0;
+
+    for(int c = j - BITBLOCK_LEFT; c <= j + BITBLOCK_RIGHT; c++)
+        window = (window << 1) | matrix_getBit(i, c);
+
+    return window;
+}
+
+/**
+ * @brief Toda la caché de ventanas coincide con la matriz.
+ */
+void matrixTest_checkWindows(){
+    for(int i = 0; i < matrixSize; i++)
+        for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(matrixSize); j++)
+            HOST_CHECK(rowWindows[i][j] == matrixTest_window(i, j));
+}
+
+/**
+ * @brief Pivot al azar; uno de cada cuatro en una esquina del rango de pivots.
+ */
+void matrixTest_randomPivot(RngState* script, uint8* i, uint8* j){
+    if(rng_bounded(script, 4) == 0){
+        *i = rng_bounded(script, 2) ? MATRIX_FIRST_PIVOT_I : MATRIX_LAST_PIVOT_I(matrixSize);
+        *j = rng_bounded(script, 2) ? MATRIX_FIRST_PIVOT_J : MATRIX_LAST_PIVOT_J(matrixSize);
+    }
+    else{
+        *i = MATRIX_FIRST_PIVOT_I + rng_bounded(script, MATRIX_PIVOTS_I(matrixSize));
+        *j = MATRIX_FIRST_PIVOT_J + rng_bounded(script, MATRIX_PIVOTS_J(matrixSize));
+    }
+}
+
+/**
+ * @brief Caché de ventanas tras cambiar celdas sueltas (incluidas la primera y la última columna,
+ * que sólo aparecen en una ventana) y tras sustituir el bloque bajo el pivot.
+ */
+void matrixTest_windows(RngState* script){
+    matrixTest_checkWindows();
+    for(int n = 0; n < MATRIX_TEST_SET_BITS; n++){
+        uint8 i = rng_bounded(script, matrixSize);
+        uint8 j = rng_bounded(script, 4) == 0 ? (matrixSize - 1) * rng_bounded(script, 2)
+                                               : rng_bounded(script, matrixSize);
+
+        matrix_setBit(i, j, !matrix_getBit(i, j));
+        for(int k = MATRIX_FIRST_PIVOT_J; k <= MATRIX_LAST_PIVOT_J(matrixSize); k++)
+            HOST_CHECK(rowWindows[i][k] == matrixTest_window(i, k));
+    }
+    matrixTest_checkWindows();
+
+    for(int n = 0; n < MATRIX_TEST_BLOCKS; n++){
+        uint8 i, j;
+
+        matrixTest_randomPivot(script, &i, &j);
+        matrix_updatePivot(i, j);
+        matrix_scrollViewport(i, j);
+        matrix_regenerateBitBlock();
+        matrixTest_checkWindows();
+        while(matrixPool_refill());
+    }
+}
+
+/**
+ * @brief Los mapas de overflow persistentes coinciden con los rehechos desde cero.
+ */
+void matrixTest_checkMaps(){
+    OverflowMap maps[OVERFLOW_MAPS];
+
+    matrix_buildRuleOverflowMaps(matrix, matrixSize, maps);
+    for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+        for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(matrixSize); i++)
+            HOST_CHECK(overflowMaps[mode].rows[i] == maps[mode].rows[i]);
+}
+
+/**
+ * @brief Colapso por gravedad con cada regla y forma. El resultado esperado se monta columna a
+ * columna: las celdas de la forma desaparecen, las de encima bajan tantas filas como celdas tenía
+ * la forma en esa columna y arriba aparecen las del bitBlockBuffer.
+ */
+void matrixTest_collapse(RngState* script){
+    static Binary before[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE];
+    BitboardRow buffer[BITBLOCK_ROWS];
+
+    for(int rule = 0; rule < OVERFLOW_RULES; rule++){
+        for(int shape = 0; shape < BITBLOCK_SHAPES; shape++){
+            uint16 mask = bitBlockShapeMasks[shape];
+
+            gameData.rule = rule;
+            gameData.shape = shape;
+            matrix_selectBitBlockEvaluation(rule, shape);
+
+            for(int n = 0; n < MATRIX_TEST_COLLAPSES; n++){
+                uint8 pi, pj;
+
+                matrixTest_randomPivot(script, &pi, &pj);
+                matrix_updatePivot(pi, pj);
+                matrix_scrollViewport(pi, pj);
+                for(int i = 0; i < matrixSize; i++)
+                    for(int j = 0; j < matrixSize; j++)
+                        before[i][j] = matrix_getBit(i, j);
+                for(int r = 0; r < BITBLOCK_ROWS; r++)
+                    buffer[r] = bitBlockBuffer[r];
+
+                matrix_collapseBitBlock();
+                while(matrix_collapseEffect())
+                    matrix_commitView();
+                matrix_commitView();
+
+                for(int j = 0; j < matrixSize; j++){
+                    int c = j - (pj - BITBLOCK_LEFT);
+                    int top = 0, height = 0, bottom = -1;
+
+                    for(int r = 0; c >= 0 && c < BITBLOCK_COLS && r < BITBLOCK_ROWS; r++){
+                        if(!((mask >> BITBLOCK_ROW_SHIFT(r)) & BIT(BITBLOCK_COL_SHIFT(c))))
+                            continue;
+                        if(height++ == 0)
+                            top = r;
+                    }
+                    if(height > 0)
+                        bottom = pi - BITBLOCK_TOP + top + height - 1;
+
+                    for(int i = 0; i < matrixSize; i++){
+                        Binary expected = before[i][j];
+
+                        if(i <= bottom)
+                            expected = i >= height ? before[i - height][j]
+                                                   : (buffer[top + i] >> BITBLOCK_COL_SHIFT(c)) & 1;
+                        HOST_CHECK(matrix_getBit(i, j) == expected);
+                    }
+                }
+                matrixTest_checkWindows();
+                matrixTest_checkMaps();
+                while(matrixPool_refill());
+            }
+        }
+    }
+    gameData.rule = GAME_DEFAULT_RULE;
+    gameData.shape = GAME_DEFAULT_SHAPE;
+    matrix_selectBitBlockEvaluation(gameData.rule, gameData.shape);
+}
+
+/**
+ * @brief Coste mínimo hasta un pivot con overflow del mapa de la dificultad actual, recorriéndolos
+ * todos.
+ * @return Coste, o @def HINT_NONE si el mapa está vacío.
+ */
+uint8 matrixTest_nearestCost(uint8 fromI, uint8 fromJ){
+    const OverflowMap* map = &overflowMaps[gameData.mode];
+    int best = HINT_NONE;
+
+    for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(matrixSize); i++)
+        for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(matrixSize); j++)
+            if((map->rows[i] & OVERFLOW_ROW_BIT(j)) && abs(i - fromI) + abs(j - fromJ) < best)
+                best = abs(i - fromI) + abs(j - fromJ);
+
+    return best;
+}
+
+/**
+ * @brief La pista desde todas las celdas de la matriz coincide con el recorrido completo y apunta
+ * a un pivot con overflow a esa distancia; con el mapa vacío no toca el pivot de salida.
+ */
+void matrixTest_checkHints(){
+    const OverflowMap* map = &overflowMaps[gameData.mode];
+
+    for(int i = 0; i < matrixSize; i++){
+        for(int j = 0; j < matrixSize; j++){
+            MatrixPivot nearest = {HINT_NONE, HINT_NONE};
+            uint8 cost = matrix_findNearestOverflow(i, j, &nearest);
+
+            HOST_CHECK(cost == matrixTest_nearestCost(i, j));
+            if(cost == HINT_NONE){
+                HOST_CHECK(nearest.i == HINT_NONE && nearest.j == HINT_NONE);
+                continue;
+            }
+            HOST_CHECK(map->rows[nearest.i] & OVERFLOW_ROW_BIT(nearest.j));
+            HOST_CHECK(abs(nearest.i - i) + abs(nearest.j - j) == cost);
+        }
+    }
+}
+
+/**
+ * @brief Pistas sobre los mapas reales de la matriz y sobre mapas sintéticos: vacío, un único pivot
+ * (en las esquinas incluidas) y densidades de 1/2 a 1/128.
+ */
+void matrixTest_hints(RngState* script){
+    OverflowMap* map;
+
+    for(int mode = 0; mode < OVERFLOW_MAPS; mode++){
+        gameData.mode = mode;
+        map = &overflowMaps[mode];
+        matrixTest_checkHints();
+
+        for(int n = 0; n < MATRIX_TEST_HINT_MAPS; n++){
+            uint8 density = rng_bounded(script, 6);
+
+            for(int i = 0; i < MATRIX_MAX_SIZE; i++)
+                map->rows[i] = 0;
+            if(density == 1){
+                uint8 i, j;
+
+                matrixTest_randomPivot(script, &i, &j);
+                map->rows[i] = OVERFLOW_ROW_BIT(j);
+            }
+            else if(density > 1){
+                for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(matrixSize); i++)
+                    for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(matrixSize); j++)
+                        if(rng_bounded(script, 2 << (2 * (density - 2))) == 0)
+                            map->rows[i] |= OVERFLOW_ROW_BIT(j);
+            }
+            matrixTest_checkHints();
+        }
+    }
+    gameData.mode = 0;
+    matrix_rebuildOverflowMaps();
+}
+
+/**
+ * @brief Regenera la matriz y la revela frame a frame. Justo después de regenerarla la caché aún
+ * es la de la matriz anterior; al acabar el revelado, en los frames que tocan, ha de estar al día
+ * en todas las filas, no sólo en las del viewport.
+ */
+void matrixTest_reveal(){
+    uint8 frames = (matrixSize + MATRIX_REVEAL_WINDOW_ROWS - 1) / MATRIX_REVEAL_WINDOW_ROWS;
+    int stale = 0;
+
+    if(frames < MATRIX_VIEW_SIZE)
+        frames = MATRIX_VIEW_SIZE;
+
+    for(int n = 0; n < MATRIX_TEST_REGENS; n++){
+        int frame = 1;
+
+        matrix_regenerateMatrix();
+        for(int i = 0; i < matrixSize; i++)
+            for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(matrixSize); j++)
+                stale += rowWindows[i][j] != matrixTest_window(i, j);
+
+        while(matrix_revealMatrixEffect()){
+            matrix_commitView();
+            frame++;
+        }
+        matrix_commitView();
+        HOST_CHECK(frame == frames);
+        matrixTest_checkWindows();
+        matrixTest_checkMaps();
+        for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(matrixSize); i++)
+            for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(matrixSize); j++)
+                HOST_CHECK(matrix_getBitBlockPattern(i, j)
+                           == (uint16) BITBLOCK_PATTERN(matrix, i, BITBLOCK_SHIFT(matrixSize, j)));
+        while(matrixPool_refill());
+    }
+    HOST_CHECK(stale > 0);
+}
+
+int main(){
+    const uint8 sizes[] = {MATRIX_MIN_SIZE, 17, MATRIX_MAX_SIZE};
+    RngState script;
+
+    rng_seed(&script, 11);
+    for(int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        rng_initSystem(RNG_DEFAULT_SEED + sizes[s]);
+        matrix_initSystem(sizes[s]);
+        matrixPool_init();
+        matrix_updatePivot(MATRIX_FIRST_PIVOT_I, MATRIX_FIRST_PIVOT_J);
+
+        matrixTest_windows(&script);
+        matrixTest_collapse(&script);
+        matrixTest_hints(&script);
+        matrixTest_reveal();
+    }
+    printf("matrixTest: caché de ventanas, colapso, pistas y regeneración correctos (%dx%d a %dx%d)\n",
+           MATRIX_MIN_SIZE, MATRIX_MIN_SIZE, MATRIX_MAX_SIZE, MATRIX_MAX_SIZE);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file refillBench.c
+ * @brief Coste de reponer el ring de bloques de bits y el pool de matrices (matrixPool.c). El
+ * Makefile lo compila una vez por profundidad del ring (-DBITBLOCK_RING_SIZE). Mide:
+ *  - cada reposición de un bloque (@fn matrixPool_refillBitBlock) y el ring entero desde vacío;
+ *  - servir un bloque (@fn matrixPool_consumeBitBlock), que no depende de la profundidad;
+ *  - cada reposición de una matriz del pool (@fn matrixPool_refill con el ring lleno).
+ * De paso comprueba que cada bloque servido es una permutación del buffer base y que el ring
+ * absorbe tantas regeneraciones seguidas como su profundidad sin ningún fallo.
+ */
+
+#include "hostBench.h"
+#include "matrixPool.h"
+#include "game.h"
+
+#define REFILL_ROUNDS 20000
+
+volatile int sink;
+
+int refillBench_ones(const BitboardRow* rows){
+    int ones = 0;
+
+    for(int i = 0; i < BITBLOCK_ROWS; i++)
+        ones += __builtin_popcount(rows[i]);
+
+    return ones;
+}
+
+int main(){
+    BitboardRow rows[BITBLOCK_ROWS];
+    double start, refillNs = 0, consumeNs = 0, boardNs, overhead = hostBench_overhead();
+    int baseOnes;
+
+    rng_initSystem(RNG_DEFAULT_SEED);
+    matrix_initSystem(MATRIX_DEFAULT_SIZE);
+    matrixPool_init();
+    HOST_CHECK(matrixPool_getBitBlockDepth() == BITBLOCK_RING_SIZE);
+    baseOnes = refillBench_ones(bitBlockBuffer);
+
+    for(int n = 0; n < REFILL_ROUNDS / BITBLOCK_RING_SIZE; n++){
+        start = hostBench_now();
+        for(int k = 0; k < BITBLOCK_RING_SIZE; k++){
+            HOST_CHECK(matrixPool_consumeBitBlock(rows));
+            sink += rows[0];
+        }
+        consumeNs += hostBench_now() - start - overhead;
+        HOST_CHECK(refillBench_ones(rows) == baseOnes);
+        HOST_CHECK(matrixPool_getBitBlockDepth() == 0);
+
+        start = hostBench_now();
+        while(matrixPool_refillBitBlock());
+        refillNs += hostBench_now() - start - overhead;
+    }
+    HOST_CHECK(matrixPoolStats.bitBlockMisses == 0);
+    consumeNs /= (REFILL_ROUNDS / BITBLOCK_RING_SIZE) * BITBLOCK_RING_SIZE;
+    refillNs /= REFILL_ROUNDS / BITBLOCK_RING_SIZE;
+
+    start = hostBench_now();
+    for(int n = 0; n < REFILL_ROUNDS / 10; n++){
+        matrixPool_consume();
+        matrixPool_refill();
+    }
+    boardNs = (hostBench_now() - start) / (REFILL_ROUNDS / 10);
+    HOST_CHECK(matrixPoolStats.misses == 0);
+
+    printf("refillBench: ring %3d, bloque %.0f ns, ring entero %.1f us, servir %.1f ns, "
+           "servir y reponer una matriz %dx%d %.1f us (pool de %d)\n", BITBLOCK_RING_SIZE, refillNs / BITBLOCK_RING_SIZE,
+           refillNs / 1000, consumeNs, MATRIX_DEFAULT_SIZE, MATRIX_DEFAULT_SIZE, boardNs / 1000, MATRIX_POOL_SIZE);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file rngTest.c
+ * @brief Uniformidad de @fn rng_bounded: chi-cuadrado del histograma para cotas pequeñas, y
+ * para cotas cercanas a 2^32 (donde un simple módulo estaría sesgado hacia los valores bajos)
+ * chi-cuadrado de los tercios/cuartos del rango. Además, @fn rng_fill tiene que dar la misma
+ * secuencia que @fn rng_next y dejar el generador en el mismo estado.
+ */
+
+#include <math.h>
+#include "hostBench.h"
+#include "rng.h"
+
+#define RNG_TEST_DRAWS 4000000
+#define RNG_TEST_BUCKETS 1000
+#define RNG_TEST_Z_LIMIT 5.0
+#define RNG_TEST_FILL 4096
+
+/**
+ * @brief Chi-cuadrado de draws llamadas a rng_bounded(bound), con los valores agrupados en
+ * buckets intervalos iguales de [0, bound). El resultado se normaliza a una normal estándar
+ * (Wilson-Hilferty), para comparar todas las cotas con el mismo límite.
+ */
+double rngTest_chi2(RngState* rng, uint32 bound, uint32 buckets){
+    static long seen[RNG_TEST_BUCKETS];
+    double chi2 = 0, expected = (double) RNG_TEST_DRAWS / buckets, dof = buckets - 1;
+
+    for(uint32 b = 0; b < buckets; b++)
+        seen[b] = 0;
+    for(int n = 0; n < RNG_TEST_DRAWS; n++){
+        uint32 value = rng_bounded(rng, bound);
+
+        HOST_CHECK(value < bound);
+        seen[(uint64) value * buckets / bound]++;
+    }
+    for(uint32 b = 0; b < buckets; b++)
+        chi2 += (seen[b] - expected) * (seen[b] - expected) / expected;
+
+    return (cbrt(chi2 / dof) - (1 - 2 / (9 * dof))) / sqrt(2 / (9 * dof));
+}
+
+/**
+ * @brief Compara rng_fill con rng_next desde la misma semilla, para buffers de varios tamaños
+ * (incluido el vacío) seguidos, de manera que cada uno arranca donde dejó el anterior.
+ * @return Nanosegundos por número de rng_fill.
+ */
+double rngTest_fill(){
+    static uint32 buffer[RNG_TEST_FILL];
+    const int sizes[] = {0, 1, 7, 64, RNG_TEST_FILL};
+    RngState fill, next;
+    double start;
+
+    rng_seed(&fill, 21);
+    rng_seed(&next, 21);
+    for(size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++){
+        rng_fill(&fill, buffer, sizes[k]);
+        for(int n = 0; n < sizes[k]; n++)
+            HOST_CHECK(buffer[n] == rng_next(&next));
+        HOST_CHECK(fill.state == next.state);
+    }
+
+    start = hostBench_now();
+    for(int n = 0; n < RNG_TEST_DRAWS / RNG_TEST_FILL; n++)
+        rng_fill(&fill, buffer, RNG_TEST_FILL);
+
+    return (hostBench_now() - start) / (RNG_TEST_DRAWS / RNG_TEST_FILL * RNG_TEST_FILL);
+}
+
+int main(){
+    const uint32 small[] = {2, 3, 7, 10, 100, 1000};
+    const uint32 large[][2] = {{3u << 30, 3}, {0xC0000001u, 3}, {0x80000001u, 2}, {0xFFFFFFFFu, 4}};
+    RngState rng;
+    double worst = 0, start, ns;
+
+    rng_seed(&rng, 8);
+    for(size_t k = 0; k < sizeof(small) / sizeof(small[0]); k++){
+        double z = rngTest_chi2(&rng, small[k], small[k]);
+
+        printf("rngTest: cota %10u, %4u buckets, z = %5.2f\n", small[k], small[k], z);
+        worst = fmax(worst, fabs(z));
+    }
+    for(size_t k = 0; k < sizeof(large) / sizeof(large[0]); k++){
+        double z = rngTest_chi2(&rng, large[k][0], large[k][1]);
+
+        printf("rngTest: cota %10u, %4u buckets, z = %5.2f\n", large[k][0], large[k][1], z);
+        worst = fmax(worst, fabs(z));
+    }
+    HOST_CHECK(worst < RNG_TEST_Z_LIMIT);
+
+    start = hostBench_now();
+    for(int n = 0; n < RNG_TEST_DRAWS; n++)
+        rng_bounded(&rng, 1 + (n & 1023));
+    ns = (hostBench_now() - start) / RNG_TEST_DRAWS;
+    printf("rngTest: peor z = %.2f (límite %.0f), rng_bounded %.1f ns/llamada, rng_fill %.2f ns/número\n",
+           worst, RNG_TEST_Z_LIMIT, ns, rngTest_fill());
+
+    return 0;
+}
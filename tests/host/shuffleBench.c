@@ -0,0 +1,207 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file shuffleBench.c
+ * @brief Permutación in situ de la matriz (@fn matrix_shuffleBitboard, que genera los intercambios
+ * con @fn matrix_drawPermutation y los aplica con @fn matrix_applyPermutation):
+ *  - @def BITBOARD_ROW_OF da n / width en todo su rango.
+ *  - Uniformidad sobre configuraciones: en un 3x3 con 4 unos hay C(9, 4) = 126 tableros posibles;
+ *    tras millones de permutaciones, chi-cuadrado contra la distribución uniforme.
+ *  - Uniformidad por celda: millones de regeneraciones seguidas del tablero por defecto, la
+ *    frecuencia de unos de cada celda (fila 0 incluida) tiene que ser la de la matriz entera.
+ *  - Coste de una regeneración frente al camino anterior (transponer a una copia, aplanar a 1D,
+ *    permutar y volver a copiar), y por separado lo que cuesta generar y aplicar los intercambios.
+ */
+
+#include <math.h>
+#include "hostBench.h"
+#include "matrix.h"
+#include "game.h"
+
+#define SHUFFLE_CONFIG_ROUNDS 4000000
+#define SHUFFLE_CELL_ROUNDS 1000000
+#define SHUFFLE_BENCH_ROUNDS 200000
+#define SHUFFLE_CONFIGS 512
+#define SHUFFLE_CONFIGS_USED 126
+#define SHUFFLE_CHI2_LIMIT 190.0 // 125 grados de libertad, p = 0.0002.
+#define SHUFFLE_MAX_Z 5.0
+
+static Binary cells[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE];
+static Binary cellsTemp[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE];
+static Binary cells1D[MATRIX_MAX_CELLS];
+volatile int sink;
+
+void shuffleBench_rowOf(){
+    for(int width = 1; width <= MATRIX_MAX_SIZE; width++)
+        for(int n = 0; n < MATRIX_MAX_CELLS; n++)
+            HOST_CHECK(BITBOARD_ROW_OF(n, BITBOARD_RECIPROCAL(width)) == n / width);
+}
+
+void shuffleBench_configs(){
+    static long seen[SHUFFLE_CONFIGS];
+    BitboardRow block[BITBLOCK_BASE_SIZE] = {0x7, 0x1, 0x0};
+    RngState rng;
+    double chi2 = 0, expected = (double) SHUFFLE_CONFIG_ROUNDS / SHUFFLE_CONFIGS_USED;
+    int used = 0;
+
+    rng_seed(&rng, 6);
+    for(int n = 0; n < SHUFFLE_CONFIG_ROUNDS; n++){
+        matrix_shuffleBitboard(&rng, block, BITBLOCK_BASE_SIZE, BITBLOCK_BASE_SIZE);
+        seen[(block[0] << 6) | (block[1] << 3) | block[2]]++;
+    }
+
+    for(int c = 0; c < SHUFFLE_CONFIGS; c++){
+        if(!seen[c])
+            continue;
+        HOST_CHECK(__builtin_popcount(c) == 4);
+        chi2 += (seen[c] - expected) * (seen[c] - expected) / expected;
+        used++;
+    }
+
+    printf("shuffleBench: 3x3, %d permutaciones, %d/%d tableros, chi2 = %.1f (límite %.0f)\n",
+           SHUFFLE_CONFIG_ROUNDS, used, SHUFFLE_CONFIGS_USED, chi2, SHUFFLE_CHI2_LIMIT);
+    HOST_CHECK(used == SHUFFLE_CONFIGS_USED);
+    HOST_CHECK(chi2 < SHUFFLE_CHI2_LIMIT);
+}
+
+void shuffleBench_cells(uint8 size){
+    static long ones[MATRIX_MAX_SIZE][MATRIX_MAX_SIZE];
+    RngState rng;
+    int total = 0;
+    double p, worst = 0;
+
+    for(int i = 0; i < size; i++)
+        total += __builtin_popcountll(matrix[i]);
+    p = (double) total / (size * size);
+
+    rng_seed(&rng, 7);
+    for(int n = 0; n < SHUFFLE_CELL_ROUNDS; n++){
+        int count = 0;
+
+        matrix_shuffleBitboard(&rng, matrix, size, size);
+        for(int i = 0; i < size; i++){
+            count += __builtin_popcountll(matrix[i]);
+            for(int j = 0; j < size; j++)
+                ones[i][j] += BITBOARD_GET(matrix[i], size, j);
+        }
+        HOST_CHECK(count == total);
+    }
+
+    for(int i = 0; i < size; i++)
+        for(int j = 0; j < size; j++){
+            double z = fabs(ones[i][j] - p * SHUFFLE_CELL_ROUNDS) / sqrt(SHUFFLE_CELL_ROUNDS * p * (1 - p));
+
+            if(z > worst)
+                worst = z;
+        }
+
+    printf("shuffleBench: %dx%d, %d regeneraciones, p(1) = %.3f, peor celda a %.2f sigmas (límite %.0f)\n",
+           size, size, SHUFFLE_CELL_ROUNDS, p, worst, SHUFFLE_MAX_Z);
+    HOST_CHECK(worst < SHUFFLE_MAX_Z);
+}
+
+/**
+ * @brief El camino de regeneración anterior: transponer a una copia, aplanar, permutar el
+ * vector 1D y volver a copiar a la matriz.
+ */
+__attribute__((noinline)) void shuffleBench_copyShuffle(RngState* rng, uint8 size){
+    int k = 0;
+
+    for(int i = 0; i < size; i++)
+        for(int j = 0; j < size; j++)
+            cellsTemp[j][i] = cells[i][j];
+    for(int i = 0; i < size; i++)
+        for(int j = 0; j < size; j++)
+            cells1D[k++] = cellsTemp[i][j];
+    for(k = (size * size) - 1; k > 0; k--){
+        int r = rng_bounded(rng, k + 1);
+        Binary aux = cells1D[k];
+
+        cells1D[k] = cells1D[r];
+        cells1D[r] = aux;
+    }
+    k = 0;
+    for(int i = 0; i < size; i++)
+        for(int j = 0; j < size; j++)
+            cells[i][j] = cells1D[k++];
+}
+
+void shuffleBench_time(uint8 size){
+    static uint16 swaps[MATRIX_MAX_CELLS];
+    RngState rng;
+    double start, copy, inPlace, draw, apply;
+
+    rng_seed(&rng, 8);
+    start = hostBench_now();
+    for(int n = 0; n < SHUFFLE_BENCH_ROUNDS; n++)
+        shuffleBench_copyShuffle(&rng, size);
+    copy = (hostBench_now() - start) / SHUFFLE_BENCH_ROUNDS;
+    sink += cells[0][0];
+
+    start = hostBench_now();
+    for(int n = 0; n < SHUFFLE_BENCH_ROUNDS; n++)
+        matrix_shuffleBitboard(&rng, matrix, size, size);
+    inPlace = (hostBench_now() - start) / SHUFFLE_BENCH_ROUNDS;
+    sink += matrix[0];
+
+    start = hostBench_now();
+    for(int n = 0; n < SHUFFLE_BENCH_ROUNDS; n++)
+        matrix_drawPermutation(&rng, swaps, size * size);
+    draw = (hostBench_now() - start) / SHUFFLE_BENCH_ROUNDS;
+
+    start = hostBench_now();
+    for(int n = 0; n < SHUFFLE_BENCH_ROUNDS; n++)
+        matrix_applyPermutation(matrix, size, size, swaps);
+    apply = (hostBench_now() - start) / SHUFFLE_BENCH_ROUNDS;
+    sink += matrix[0];
+
+    printf("shuffleBench: %dx%d, copia+transpuesta %.0f ns/regeneración, in situ %.0f ns/regeneración "
+           "(generar %.0f ns, aplicar %.0f ns)\n", size, size, copy, inPlace, draw, apply);
+}
+
+/**
+ * @brief @fn matrix_permuteMatrix deja los mapas persistentes igual que recalculados de cero.
+ */
+void shuffleBench_permuteMatrix(){
+    for(int n = 0; n < 1000; n++){
+        OverflowMap map;
+
+        matrix_permuteMatrix();
+        matrix_computeOverflowMap(&map);
+        for(int i = 0; i < MATRIX_MAX_SIZE; i++)
+            HOST_CHECK(map.rows[i] == matrix_getOverflowMap()->rows[i]);
+    }
+}
+
+int main(){
+    rng_initSystem(RNG_DEFAULT_SEED);
+    matrix_initSystem(MATRIX_DEFAULT_SIZE);
+
+    shuffleBench_rowOf();
+    shuffleBench_permuteMatrix();
+    shuffleBench_configs();
+    shuffleBench_cells(matrix_getSize());
+    shuffleBench_time(MATRIX_DEFAULT_SIZE);
+    shuffleBench_time(MATRIX_MAX_SIZE);
+
+    return 0;
+}
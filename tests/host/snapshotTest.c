@@ -0,0 +1,178 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file snapshotTest.c
+ * @brief Rebobinado de una partida con @fn matrixSnapshot_save/@fn matrixSnapshot_restore: se
+ * captura el estado, se juega un guion de jugadas, se restaura y al volver a jugarlo el estado tiene
+ * que ser idéntico jugada a jugada. También comprueba que se rechazan registros inválidos, que se
+ * puede restaurar un tablero de otro tamaño, y mide lo que cuesta guardar y restaurar.
+ */
+
+#include "hostBench.h"
+#include "matrixSnapshot.h"
+#include "matrixPool.h"
+#include "game.h"
+
+#define SNAPSHOT_TEST_WARMUP 50
+#define SNAPSHOT_TEST_MOVES 300
+#define SNAPSHOT_TEST_SAVES 200000
+#define SNAPSHOT_TEST_RESTORES 20000
+
+/**
+ * @brief Resumen (FNV-1a) de todo lo que guarda un snapshot y de lo que se recalcula al
+ * restaurarlo (mapas de overflow).
+ */
+uint32 snapshotTest_hashState(){
+    uint32 hash = 2166136261u;
+
+    for(int i = 0; i < matrixSize; i++)
+        hash = (hash ^ matrix[i]) * 16777619u;
+    for(int i = 0; i < BITBLOCK_ROWS; i++)
+        hash = (hash ^ bitBlockBuffer[i]) * 16777619u;
+    hash = (hash ^ pivot->i) * 16777619u;
+    hash = (hash ^ pivot->j) * 16777619u;
+    hash = (hash ^ gameRng.state) * 16777619u;
+    for(int mode = 0; mode < OVERFLOW_MAPS; mode++)
+        for(int i = 0; i < MATRIX_MAX_SIZE; i++)
+            hash = (hash ^ overflowMaps[mode].rows[i]) * 16777619u;
+
+    return hash;
+}
+
+/**
+ * @brief Juega moves jugadas sacadas de script: regenerar la matriz (con su revelado), mover el
+ * pivot y regenerar el bitblock, o consumir un número de @var gameRng. Tras cada una se rellena el
+ * pool, como en el loop principal.
+ * @return Resumen de los estados tras cada jugada.
+ */
+uint32 snapshotTest_play(RngState script, int moves){
+    uint32 hash = 0;
+
+    for(int n = 0; n < moves; n++){
+        switch(rng_bounded(&script, 3)){
+            case 0:
+                matrix_regenerateMatrix();
+                while(matrix_revealMatrixEffect())
+                    matrix_commitView();
+                break;
+            case 1: {
+                uint8 i = MATRIX_FIRST_PIVOT_I + rng_bounded(&script, MATRIX_PIVOTS_I(matrixSize));
+                uint8 j = MATRIX_FIRST_PIVOT_J + rng_bounded(&script, MATRIX_PIVOTS_J(matrixSize));
+
+                matrix_updatePivot(i, j);
+                matrix_scrollViewport(i, j);
+                matrix_regenerateBitBlock();
+                break;
+            }
+            default:
+                rng_next(&gameRng);
+                break;
+        }
+        while(matrixPool_refill());
+        hash = hash * 31 + snapshotTest_hashState();
+    }
+
+    return hash;
+}
+
+void snapshotTest_run(uint8 size){
+    MatrixSnapshot snapshot, bad;
+    RngState script;
+    uint32 before, after, first, replay;
+    uint8 bytes;
+    double start, saveNs, restoreNs;
+
+    rng_initSystem(RNG_DEFAULT_SEED + size);
+    matrix_initSystem(size);
+    matrixPool_init();
+    matrix_updatePivot(MATRIX_FIRST_PIVOT_I, MATRIX_FIRST_PIVOT_J);
+    rng_seed(&script, 1);
+    snapshotTest_play(script, SNAPSHOT_TEST_WARMUP);
+
+    bytes = matrixSnapshot_save(&snapshot);
+    HOST_CHECK(bytes == SNAPSHOT_BYTES(size));
+    before = snapshotTest_hashState();
+    rng_seed(&script, 2);
+    first = snapshotTest_play(script, SNAPSHOT_TEST_MOVES);
+    after = snapshotTest_hashState();
+    HOST_CHECK(after != before);
+
+    HOST_CHECK(matrixSnapshot_restore(&snapshot));
+    HOST_CHECK(snapshotTest_hashState() == before);
+    while(matrixPool_refill());
+    replay = snapshotTest_play(script, SNAPSHOT_TEST_MOVES);
+    HOST_CHECK(replay == first && snapshotTest_hashState() == after);
+    for(int i = MATRIX_FIRST_PIVOT_I; i <= MATRIX_LAST_PIVOT_I(size); i++)
+        for(int j = MATRIX_FIRST_PIVOT_J; j <= MATRIX_LAST_PIVOT_J(size); j++)
+            HOST_CHECK(matrix_getBitBlockPattern(i, j) == (uint16) BITBLOCK_PATTERN(matrix, i, BITBLOCK_SHIFT(size, j)));
+
+    bad = snapshot;
+    bad.data[SNAPSHOT_SIZE] = MATRIX_MAX_SIZE + 1;
+    HOST_CHECK(!matrixSnapshot_restore(&bad));
+    bad = snapshot;
+    bad.data[SNAPSHOT_PIVOT_I] = 0;
+    HOST_CHECK(!matrixSnapshot_restore(&bad));
+    bad = snapshot;
+    matrixSnapshot_writeWord(&bad.data[SNAPSHOT_GAME_RNG], 0);
+    HOST_CHECK(!matrixSnapshot_restore(&bad));
+
+    start = hostBench_now();
+    for(int n = 0; n < SNAPSHOT_TEST_SAVES; n++)
+        matrixSnapshot_save(&snapshot);
+    saveNs = (hostBench_now() - start) / SNAPSHOT_TEST_SAVES;
+    start = hostBench_now();
+    for(int n = 0; n < SNAPSHOT_TEST_RESTORES; n++)
+        matrixSnapshot_restore(&snapshot);
+    restoreNs = (hostBench_now() - start) / SNAPSHOT_TEST_RESTORES;
+
+    printf("snapshotTest: %dx%d, %u bytes, guardar %.0f ns, restaurar %.0f ns (con los mapas)\n",
+           size, size, bytes, saveNs, restoreNs);
+}
+
+int main(){
+    MatrixSnapshot snapshot;
+    uint32 hash;
+
+    snapshotTest_run(MATRIX_DEFAULT_SIZE);
+    snapshotTest_run(17);
+    snapshotTest_run(MATRIX_MAX_SIZE);
+
+    /*
+     * Un snapshot de 10x10 se restaura sobre un tablero de 32x32: vuelve el tamaño y la vista
+     * se recoloca en el origen.
+     */
+    rng_initSystem(RNG_DEFAULT_SEED);
+    matrix_initSystem(MATRIX_DEFAULT_SIZE);
+    matrixPool_init();
+    matrix_updatePivot(4, 4);
+    matrixSnapshot_save(&snapshot);
+    hash = snapshotTest_hashState();
+    matrix_initSystem(MATRIX_MAX_SIZE);
+    matrixPool_init();
+    matrix_updatePivot(20, 20);
+    matrix_scrollViewport(20, 20);
+    HOST_CHECK(matrixSnapshot_restore(&snapshot));
+    HOST_CHECK(matrixSize == MATRIX_DEFAULT_SIZE && snapshotTest_hashState() == hash);
+    HOST_CHECK(viewport.i == 0 && viewport.j == 0);
+
+    return 0;
+}
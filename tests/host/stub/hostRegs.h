@@ -0,0 +1,38 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file hostRegs.h
+ * @brief Se incluye antes que nada al compilar en el PC (ver Makefile), ya que hay módulos que
+ * guardan y restauran IME (eventMgr.c, matrixPool.c): el registro pasa a ser una variable normal,
+ * definida en stubs.c.
+ */
+
+#ifndef INATRIX_OVERFLOW_HOST_REGS_H
+#define INATRIX_OVERFLOW_HOST_REGS_H
+
+#include "defines.h"
+
+#undef IME
+extern uint32 hostIME;
+#define IME hostIME
+
+#endif //INATRIX_OVERFLOW_HOST_REGS_H
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file nds.h
+ * @brief Subconjunto mínimo de libnds para compilar en el PC los módulos que no tocan hardware
+ * (matrix, matrixPool, rng, eventMgr...). Solo tipos y funciones vacías: nada de lo que se
+ * declara aquí hace nada.
+ */
+
+#ifndef INATRIX_OVERFLOW_HOST_NDS_H
+#define INATRIX_OVERFLOW_HOST_NDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+typedef volatile uint16_t vuint16;
+typedef volatile uint32_t vuint32;
+typedef volatile u16 vu16;
+
+#define BIT(n) (1 << (n))
+#define iprintf printf
+
+typedef enum { SpriteSize_16x16 = 1, SpriteSize_32x32 = 2 } SpriteSize;
+typedef enum { SpriteColorFormat_256Color = 1 } SpriteColorFormat;
+
+typedef struct {
+    int x, y;
+    bool isHidden;
+} SpriteEntry;
+
+typedef struct {
+    SpriteEntry oamMemory[128];
+} OamState;
+
+extern OamState oamMain, oamSub;
+
+static inline void oamUpdate(OamState* oam){ (void) oam; }
+
+#endif //INATRIX_OVERFLOW_HOST_NDS_H
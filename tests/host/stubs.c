@@ -0,0 +1,59 @@
+/*
+ * This file is part of the Iñatrix Overflow Project.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Github: https://github.com/Geru-Scotland/inatrix_overflow
+ */
+
+/**
+ * @author Geru-Scotland.
+ * @file stubs.c
+ * @brief Lo que matrix.c y matrixPool.c necesitan del resto del juego para enlazar en el PC:
+ * los datos globales, el registro IME (ver stub/hostRegs.h) y una vista de sprites que solo guarda
+ * posiciones, sin gráficos.
+ */
+
+#include "game.h"
+#include "timer.h"
+#include "sprites.h"
+
+OamState oamMain, oamSub;
+GameData gameData;
+TimerData timer;
+uint32 hostIME = 1;
+
+static GfxData digitGfx[2];
+
+void sprites_setSpriteGfx(uint8 index, GfxData* gfx, int x, int y, bool isHidden){
+    oamMain.oamMemory[index].x = x;
+    oamMain.oamMemory[index].y = y;
+    oamMain.oamMemory[index].isHidden = isHidden;
+}
+
+SpriteEntry* sprites_getSpriteEntryByIndex(uint8 index){
+    return &oamMain.oamMemory[index];
+}
+
+void gfxInfo_initMatrix(uint8* view, uint8 rows, uint8 cols){
+    static uint8 next;
+
+    for(int k = 0; k < rows * cols; k++)
+        view[k] = next++ % 128;
+}
+
+GfxData* gfxInfo_getDigitGfx(Binary bit){
+    return &digitGfx[bit];
+}